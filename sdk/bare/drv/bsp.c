@@ -1,11 +1,14 @@
 #include "bsp.h"
 #include "analog.h"
+#include "cpu_timer.h"
 #include "encoder.h"
 #include "gpio.h"
+#include "intc.h"
 #include "io.h"
 #include "pwm.h"
 #include "timer.h"
 #include "dac.h"
+#include "dma.h"
 #include "uart.h"
 #include "../sys/cmd/cmd_hw.h"
 #include "../sys/defines.h"
@@ -17,17 +20,21 @@ void bsp_init(void)
 
 	int err;
 
+	intc_init();
+
 	err = uart_init();
 	if (err != SUCCESS) {
 		HANG;
 	}
 
+	cpu_timer_init();
 	encoder_init();
 	analog_init();
 	pwm_init();
 	io_init();
 	gpio_init();
 	dac_init();
+	dma_init();
 
 	cmd_hw_register();
 }
@@ -0,0 +1,76 @@
+#include "cpu_timer.h"
+#include "xil_io.h"
+#include "xparameters.h"
+#include <stdio.h>
+
+#define GTIMER_BASE_ADDR			(XPAR_GLOBAL_TMR_BASEADDR)
+#define GTIMER_COUNTER_LOWER		(GTIMER_BASE_ADDR + 0x00)
+#define GTIMER_COUNTER_UPPER		(GTIMER_BASE_ADDR + 0x04)
+#define GTIMER_CONTROL				(GTIMER_BASE_ADDR + 0x08)
+
+void cpu_timer_init(void)
+{
+	printf("CPUTMR:\tInitializing...\n");
+
+	// Make sure the global timer is counting. The FSBL normally
+	// starts it, but don't rely on that.
+	uint32_t ctrl = Xil_In32(GTIMER_CONTROL);
+	if ((ctrl & 0x1) == 0) {
+		Xil_Out32(GTIMER_CONTROL, ctrl | 0x1);
+	}
+}
+
+uint32_t cpu_timer_now(void)
+{
+	return Xil_In32(GTIMER_COUNTER_LOWER);
+}
+
+double cpu_timer_ticks_to_usec(uint32_t ticks)
+{
+	return (double) ticks / (double) CPU_TIMER_TICKS_PER_USEC;
+}
+
+uint64_t cpu_timer_now64(void)
+{
+	uint32_t upper;
+	uint32_t lower;
+
+	// The two halves are separate registers, so re-read if
+	// the lower half wrapped into the upper half in between
+	do {
+		upper = Xil_In32(GTIMER_COUNTER_UPPER);
+		lower = Xil_In32(GTIMER_COUNTER_LOWER);
+	} while (Xil_In32(GTIMER_COUNTER_UPPER) != upper);
+
+	return ((uint64_t) upper << 32) | lower;
+}
+
+// Converts ticks to units of 1/'per_sec' seconds, splitting off whole
+// seconds first so the multiply can't overflow 64 bits
+static inline uint64_t _ticks_to(uint64_t ticks, uint64_t per_sec)
+{
+	uint64_t sec = ticks / CPU_TIMER_TICKS_PER_SEC;
+	uint64_t rem = ticks % CPU_TIMER_TICKS_PER_SEC;
+
+	return (sec * per_sec) + ((rem * per_sec) / CPU_TIMER_TICKS_PER_SEC);
+}
+
+uint64_t cpu_timer_ticks_to_usec64(uint64_t ticks)
+{
+	return _ticks_to(ticks, 1000000ULL);
+}
+
+uint64_t cpu_timer_ticks_to_nsec(uint64_t ticks)
+{
+	return _ticks_to(ticks, NSEC_IN_SEC);
+}
+
+uint64_t cpu_timer_get_usec(void)
+{
+	return cpu_timer_ticks_to_usec64(cpu_timer_now64());
+}
+
+uint64_t cpu_timer_get_nsec(void)
+{
+	return cpu_timer_ticks_to_nsec(cpu_timer_now64());
+}
@@ -0,0 +1,36 @@
+#ifndef CPU_TIMER_H
+#define CPU_TIMER_H
+
+#include <stdint.h>
+#include "xparameters.h"
+
+// The Cortex-A9 global timer is clocked at half the CPU clock.
+//
+// At 666.6 MHz CPU clock, this gives 333.3M ticks per second,
+// i.e. one tick every 3 ns.
+//
+#define CPU_TIMER_TICKS_PER_SEC		(XPAR_CPU_CORTEXA9_CORE_CLOCK_FREQ_HZ / 2)
+#define CPU_TIMER_TICKS_PER_USEC	(CPU_TIMER_TICKS_PER_SEC / 1000000)
+
+#define NSEC_IN_SEC					(1000000000ULL)
+
+void cpu_timer_init(void);
+
+// Returns lower 32 bits of the global timer. Wraps every ~12.9 sec,
+// so only use this to measure short intervals (via unsigned subtraction).
+// This is a single register read, so it is cheap enough for hot paths.
+uint32_t cpu_timer_now(void);
+
+// Returns the full 64-bit global timer, read without tearing.
+// This is monotonic and never wraps in practice.
+uint64_t cpu_timer_now64(void);
+
+// Monotonic time since power-up
+uint64_t cpu_timer_get_usec(void);
+uint64_t cpu_timer_get_nsec(void);
+
+double cpu_timer_ticks_to_usec(uint32_t ticks);
+uint64_t cpu_timer_ticks_to_usec64(uint64_t ticks);
+uint64_t cpu_timer_ticks_to_nsec(uint64_t ticks);
+
+#endif // CPU_TIMER_H
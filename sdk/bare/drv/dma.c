@@ -0,0 +1,118 @@
+#include "dma.h"
+#include "intc.h"
+#include "xdmaps.h"
+#include "xparameters.h"
+#include "../sys/defines.h"
+#include <stdio.h>
+#include <string.h>
+
+// Bare-metal code runs in the secure world, so use the secure controller
+#define DMA_DEVICE_ID				XPAR_XDMAPS_1_DEVICE_ID
+#define INTC_DMA_FAULT_INTERRUPT_ID	XPAR_XDMAPS_0_FAULT_INTR
+
+static const uint32_t done_int_ids[DMA_NUM_CHANNELS] = {
+	XPAR_XDMAPS_0_DONE_INTR_0, XPAR_XDMAPS_0_DONE_INTR_1,
+	XPAR_XDMAPS_0_DONE_INTR_2, XPAR_XDMAPS_0_DONE_INTR_3,
+	XPAR_XDMAPS_0_DONE_INTR_4, XPAR_XDMAPS_0_DONE_INTR_5,
+	XPAR_XDMAPS_0_DONE_INTR_6, XPAR_XDMAPS_0_DONE_INTR_7,
+};
+
+static void (*const done_isrs[DMA_NUM_CHANNELS])(XDmaPs *) = {
+	XDmaPs_DoneISR_0, XDmaPs_DoneISR_1, XDmaPs_DoneISR_2, XDmaPs_DoneISR_3,
+	XDmaPs_DoneISR_4, XDmaPs_DoneISR_5, XDmaPs_DoneISR_6, XDmaPs_DoneISR_7,
+};
+
+static XDmaPs dmac;
+
+// The driver holds on to the command until the copy is done
+typedef struct dma_chan_t {
+	XDmaPs_Cmd cmd;
+	dma_done_t done;
+	void *arg;
+} dma_chan_t;
+
+static dma_chan_t chans[DMA_NUM_CHANNELS];
+
+static void _done_handler(unsigned int channel, XDmaPs_Cmd *cmd, void *ref)
+{
+	dma_chan_t *c = (dma_chan_t *) ref;
+
+	if (c->done != NULL) {
+		c->done(c->arg);
+	}
+}
+
+static void _fault_handler(unsigned int channel, XDmaPs_Cmd *cmd, void *ref)
+{
+	// Only a bad address gets here, which is a bug
+	printf("ERROR: DMA channel %u fault type 0x%08x\n", channel, (unsigned) cmd->ChanFaultType);
+	HANG;
+}
+
+void dma_init(void)
+{
+	printf("DMA:\tInitializing...\n");
+
+	XDmaPs_Config *config = XDmaPs_LookupConfig(DMA_DEVICE_ID);
+	if (config == NULL) {
+		printf("ERROR: XDmaPs_LookupConfig() failed\n");
+		HANG;
+	}
+
+	int status = XDmaPs_CfgInitialize(&dmac, config, config->BaseAddress);
+	if (status != XST_SUCCESS) {
+		printf("ERROR: XDmaPs_CfgInitialize() failed\n");
+		HANG;
+	}
+
+	intc_connect(INTC_DMA_FAULT_INTERRUPT_ID, INTC_PRIORITY_DMA, INTC_TRIGGER_LEVEL,
+			(Xil_InterruptHandler) XDmaPs_FaultISR, &dmac);
+
+	XDmaPs_SetFaultHandler(&dmac, _fault_handler, NULL);
+
+	for (int i = 0; i < DMA_NUM_CHANNELS; i++) {
+		XDmaPs_SetDoneHandler(&dmac, i, _done_handler, &chans[i]);
+
+		intc_connect(done_int_ids[i], INTC_PRIORITY_DMA, INTC_TRIGGER_LEVEL,
+				(Xil_InterruptHandler) done_isrs[i], &dmac);
+	}
+}
+
+int dma_copy(int chan, void *dst, const void *src, uint32_t bytes, dma_done_t done, void *arg)
+{
+	if (chan < 0 || chan >= DMA_NUM_CHANNELS || bytes == 0 || (bytes % 4) != 0) {
+		return FAILURE;
+	}
+
+	if (XDmaPs_IsActive(&dmac, chan)) {
+		return FAILURE;
+	}
+
+	dma_chan_t *c = &chans[chan];
+
+	c->done = done;
+	c->arg = arg;
+
+	// Word-sized bursts of 4, both addresses incrementing
+	memset(&c->cmd, 0, sizeof(c->cmd));
+	c->cmd.ChanCtrl.SrcBurstSize = 4;
+	c->cmd.ChanCtrl.SrcBurstLen = 4;
+	c->cmd.ChanCtrl.SrcInc = 1;
+	c->cmd.ChanCtrl.DstBurstSize = 4;
+	c->cmd.ChanCtrl.DstBurstLen = 4;
+	c->cmd.ChanCtrl.DstInc = 1;
+	c->cmd.BD.SrcAddr = (UINTPTR) src;
+	c->cmd.BD.DstAddr = (UINTPTR) dst;
+	c->cmd.BD.Length = bytes;
+
+	if (XDmaPs_Start(&dmac, chan, &c->cmd, 0) != XST_SUCCESS) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+uint8_t dma_is_busy(int chan)
+{
+	return XDmaPs_IsActive(&dmac, chan) ? 1 : 0;
+}
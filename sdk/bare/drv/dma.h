@@ -0,0 +1,31 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include <stdint.h>
+
+// PS DMA controller (PL330), used for memory to memory copies
+// which the CPU should not spend its time on.
+//
+// XDmaPs_Start() cleans the source range from the data cache and
+// invalidates the destination range before the transfer starts, so
+// buffers only need to be cache line aligned, and the CPU must not
+// write the destination while it belongs to the DMA.
+
+#define DMA_NUM_CHANNELS		(8)
+
+// Channels handed out to users
+#define DMA_CHANNEL_LOG			(0)
+
+// Called from the DMA done interrupt
+typedef void (*dma_done_t)(void *arg);
+
+void dma_init(void);
+
+// Starts copying 'bytes' (a multiple of 4) from 'src' to 'dst' and
+// returns without waiting. Returns FAILURE if the channel is still busy
+// with the last copy. 'done' may run before this returns.
+int dma_copy(int chan, void *dst, const void *src, uint32_t bytes, dma_done_t done, void *arg);
+
+uint8_t dma_is_busy(int chan);
+
+#endif // DMA_H
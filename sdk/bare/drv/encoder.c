@@ -1,7 +1,7 @@
 #include "encoder.h"
 #include "io.h"
 #include "../sys/defines.h"
-#include "../sys/scheduler.h"
+#include "../sys/timers.h"
 #include "../usr/params/inverter.h"
 #include "../usr/params/machine.h"
 #include <stdio.h>
@@ -39,64 +39,44 @@ void encoder_get_position(uint32_t *position)
 
 
 // ****************
-// State Machine which finds z pulse
+// Timer which finds z pulse
 // ****************
 
-typedef enum sm_states_e {
-	WAIT_UNTIL_Z,
-	REMOVE_TASK
-} sm_states_e;
+// Repeating timer while searching, else -1
+static int find_z_timer = -1;
 
-typedef struct sm_ctx_t {
-	sm_states_e state;
-	double vPercent;
-	double theta;
-	double theta_delta;
-	int counter;
-	task_control_block_t tcb;
-} sm_ctx_t;
-
-#define SM_UPDATES_PER_SEC		(10000)
-#define SM_INTERVAL_USEC		(USEC_IN_SEC / SM_UPDATES_PER_SEC)
-
-static void _find_z_callback(void *arg)
+static void _find_z_poll(void *arg)
 {
-	sm_ctx_t *ctx = (sm_ctx_t *) arg;
-
-	switch (ctx->state) {
-	case WAIT_UNTIL_Z:
-	{
-		uint32_t pos;
-		encoder_get_position(&pos);
-		if (pos != -1) ctx->state = REMOVE_TASK;
-		break;
+	// Position reads -1 until the z pulse has been seen
+	uint32_t pos;
+	encoder_get_position(&pos);
+	if (pos == -1) {
+		return;
 	}
 
-	case REMOVE_TASK:
-	{
-		scheduler_tcb_unregister(&ctx->tcb);
-
-		io_led_color_t color;
-		color.b = 0;
-		io_led_set_c(0, 0, 1, &color);
+	io_led_color_t color;
+	color.b = 0;
+	io_led_set_c(0, 0, 1, &color);
 
-		break;
-	}
-	}
+	timer_cancel(find_z_timer);
+	find_z_timer = -1;
 }
 
-static sm_ctx_t ctx;
-
-void encoder_find_z()
+int encoder_find_z(void)
 {
-	// Initialize the state machine context
-	ctx.state = WAIT_UNTIL_Z;
+	// Already searching
+	if (find_z_timer >= 0) {
+		return FAILURE;
+	}
+
+	find_z_timer = timer_every(ENCODER_FIND_Z_POLL_USEC, _find_z_poll, NULL);
+	if (find_z_timer < 0) {
+		return FAILURE;
+	}
 
 	io_led_color_t color;
 	color.b = 255;
 	io_led_set_c(0, 0, 1, &color);
 
-	// Initialize the state machine callback tcb
-	scheduler_tcb_init(&ctx.tcb, _find_z_callback, &ctx, "find_z", SM_INTERVAL_USEC);
-	scheduler_tcb_register(&ctx.tcb);
+	return SUCCESS;
 }
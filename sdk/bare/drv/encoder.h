@@ -6,6 +6,9 @@
 #define ENCODER_PULSES_PER_REV_BITS		(14)
 #define ENCODER_PULSES_PER_REV			(1 << ENCODER_PULSES_PER_REV_BITS)
 
+// How often encoder_find_z() checks for the z pulse
+#define ENCODER_FIND_Z_POLL_USEC		(1000)
+
 void encoder_init(void);
 
 void encoder_set_pulses_per_rev_bits(uint32_t bits);
@@ -13,6 +16,6 @@ void encoder_set_pulses_per_rev_bits(uint32_t bits);
 void encoder_get_steps(int32_t *steps);
 void encoder_get_position(uint32_t *position);
 
-void encoder_find_z();
+int encoder_find_z(void);
 
 #endif // ENCODER_H
@@ -0,0 +1,48 @@
+#include "intc.h"
+#include "xscugic.h"
+#include "xparameters.h"
+#include "../sys/defines.h"
+#include <stdio.h>
+
+static XScuGic intCtrl;
+
+void intc_init(void)
+{
+	printf("INTC:\tInitializing...\n");
+
+	// Initialize the interrupt controller driver so that it is ready to use.
+	XScuGic_Config *IntcConfig = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
+	if (NULL == IntcConfig) {
+		printf("ERROR: XScuGic_LookupConfig() failed\n");
+		HANG;
+	}
+
+	int Status = XScuGic_CfgInitialize(&intCtrl, IntcConfig, IntcConfig->CpuBaseAddress);
+	if (Status != XST_SUCCESS) {
+		printf("ERROR: XScuGic_CfgInitialize() failed\n");
+		HANG;
+	}
+
+	// Initialize the exception table.
+	Xil_ExceptionInit();
+
+	// Register the interrupt controller handler with the exception table.
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT, (Xil_ExceptionHandler) XScuGic_InterruptHandler, (void *) &intCtrl);
+
+	// Enable exceptions.
+	Xil_ExceptionEnable();
+}
+
+void intc_connect(uint32_t int_id, uint8_t priority, uint8_t trigger,
+		Xil_InterruptHandler handler, void *callback_ref)
+{
+	XScuGic_SetPriorityTriggerType(&intCtrl, int_id, priority, trigger);
+
+	int Status = XScuGic_Connect(&intCtrl, int_id, handler, callback_ref);
+	if (Status != XST_SUCCESS) {
+		printf("ERROR: XScuGic_Connect() failed\n");
+		HANG;
+	}
+
+	XScuGic_Enable(&intCtrl, int_id);
+}
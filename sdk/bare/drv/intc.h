@@ -0,0 +1,20 @@
+#ifndef INTC_H
+#define INTC_H
+
+#include <stdint.h>
+#include "xil_exception.h"
+
+// Interrupt priorities, lower value is more urgent
+#define INTC_PRIORITY_TIMER		(0xA0)
+#define INTC_PRIORITY_DMA		(0xA4)
+#define INTC_PRIORITY_UART		(0xA8)
+
+// Trigger types
+#define INTC_TRIGGER_LEVEL		(0x1)
+#define INTC_TRIGGER_EDGE		(0x3)
+
+void intc_init(void);
+void intc_connect(uint32_t int_id, uint8_t priority, uint8_t trigger,
+		Xil_InterruptHandler handler, void *callback_ref);
+
+#endif // INTC_H
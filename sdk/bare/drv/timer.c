@@ -1,5 +1,5 @@
 #include "timer.h"
-#include "xscugic.h"
+#include "intc.h"
 #include "xtmrctr.h"
 #include "xparameters.h"
 #include <stdio.h>
@@ -11,7 +11,6 @@
 
 // PERIOD = ((2^32-1)  (TMR_LOAD_VALUE) + 2) * 5e-9
 
-static XScuGic intCtrl;
 static XTmrCtr timer;
 
 void fatalError(char *str)
@@ -28,32 +27,9 @@ void timer_init(XTmrCtr_Handler timer_isr, uint32_t timer_period_usec)
     }
     XTmrCtr_SetHandler(&timer, timer_isr, (void*) 0x12345678);
 
-    // Initialize the interrupt controller driver so that it is ready to use.
-    XScuGic_Config *IntcConfig = XScuGic_LookupConfig(XPAR_PS7_SCUGIC_0_DEVICE_ID);
-    if (NULL == IntcConfig) {
-        fatalError("XScuGic_LookupConfig() failed");
-    }
-
-    int Status = XScuGic_CfgInitialize(&intCtrl, IntcConfig,IntcConfig->CpuBaseAddress);
-    if (Status != XST_SUCCESS) {
-        fatalError("XScuGic_CfgInitialize() failed");
-    }
-
-    XScuGic_SetPriorityTriggerType(&intCtrl, INTC_TMR_INTERRUPT_ID, 0xA0, 0x3);
-    Status = XScuGic_Connect(&intCtrl, INTC_TMR_INTERRUPT_ID,(Xil_InterruptHandler)XTmrCtr_InterruptHandler,&timer);
-    if (Status != XST_SUCCESS) {
-        fatalError("XScuGic_Connect() failed");
-    }
-    XScuGic_Enable(&intCtrl, INTC_TMR_INTERRUPT_ID);
-
-    // Initialize the exception table.
-    Xil_ExceptionInit();
-
-    // Register the interrupt controller handler with the exception table.
-    Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_INT,(Xil_ExceptionHandler)XScuGic_InterruptHandler,(void *)&intCtrl);
-
-    // Enable exceptions.
-    Xil_ExceptionEnable();
+    // Timer interrupt goes through the GIC, set up in intc_init()
+    intc_connect(INTC_TMR_INTERRUPT_ID, INTC_PRIORITY_TIMER, INTC_TRIGGER_EDGE,
+    		(Xil_InterruptHandler) XTmrCtr_InterruptHandler, &timer);
 
     XTmrCtr_SetOptions(&timer, 0,   XTC_INT_MODE_OPTION | XTC_AUTO_RELOAD_OPTION);
     XTmrCtr_SetResetValue(&timer, 0, TIMER_LOAD_VALUE(timer_period_usec));
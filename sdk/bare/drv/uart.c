@@ -1,4 +1,5 @@
 #include "uart.h"
+#include "intc.h"
 #include "../sys/defines.h"
 #include "xuartps.h"
 #include "xparameters.h"
@@ -26,6 +27,27 @@ volatile int TotalReceivedCount;
 volatile int TotalSentCount;
 int TotalErrorCount;
 
+static event_t rx_event;
+
+// Only wakes up the reader: mask RX interrupts until
+// uart_recv() has drained the FIFO and re-armed them
+static void _rx_isr(void *arg)
+{
+	XUartPs_SetInterruptMask(&UartPs, 0);
+	event_post(rx_event);
+}
+
+static void _rx_arm(void)
+{
+	XUartPs_WriteReg(UartPs.Config.BaseAddress, XUARTPS_ISR_OFFSET, XUARTPS_IXR_RXOVR);
+	XUartPs_SetInterruptMask(&UartPs, XUARTPS_IXR_RXOVR);
+
+	// Data left over after a partial read might not raise a new interrupt
+	if (XUartPs_IsReceiveData(UartPs.Config.BaseAddress)) {
+		event_post(rx_event);
+	}
+}
+
 
 int uart_init(void)
 {
@@ -113,6 +135,12 @@ int uart_init(void)
 	/* Restore to normal mode. */
 	XUartPs_SetOperMode(UartInstPtr, XUARTPS_OPER_MODE_NORMAL);
 
+	/* Interrupt as soon as a single byte arrives. */
+	rx_event = event_create();
+	XUartPs_SetFifoThreshold(UartInstPtr, 1);
+	intc_connect(XPAR_XUARTPS_0_INTR, INTC_PRIORITY_UART, INTC_TRIGGER_LEVEL, _rx_isr, UartInstPtr);
+	_rx_arm();
+
 	return SUCCESS;
 }
 
@@ -123,5 +151,13 @@ int uart_send(char *msg, int len)
 
 int uart_recv(char *msg, int len)
 {
-	return XUartPs_Recv(&UartPs, (uint8_t*) msg, len);
+	int num_bytes = XUartPs_Recv(&UartPs, (uint8_t*) msg, len);
+	_rx_arm();
+
+	return num_bytes;
+}
+
+event_t uart_get_rx_event(void)
+{
+	return rx_event;
 }
@@ -2,6 +2,7 @@
 #define UART_H
 
 #include <stdint.h>
+#include "../sys/event.h"
 
 #define UART_RX_FIFO_LENGTH		(64)
 #define UART_TX_FIFO_LENGTH		(64)
@@ -11,4 +12,7 @@ int uart_init(void);
 int uart_send(char *msg, int len);
 int uart_recv(char *msg, int len);
 
+// Posted from the UART interrupt when received data is waiting
+event_t uart_get_rx_event(void);
+
 #endif // UART_H
@@ -23,6 +23,8 @@
 #include "sys/log.h"
 #include "sys/platform.h"
 #include "sys/scheduler.h"
+#include "sys/symbols.h"
+#include "sys/trace.h"
 #include "usr/user_apps.h"
 
 int main()
@@ -37,6 +39,8 @@ int main()
 	serial_init();
 	commands_init();
 	log_init();
+	trace_init();
+	symbols_init();
 
 	// Initialize user applications
 	user_apps_init();
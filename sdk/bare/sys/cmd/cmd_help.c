@@ -27,7 +27,9 @@ int cmd_help(int argc, char **argv)
 		return INVALID_ARGUMENTS;
 	}
 
-	commands_display_help();
+	if (commands_display_help() != SUCCESS) {
+		return FAILURE;
+	}
 
 	return SUCCESS_QUIET;
 }
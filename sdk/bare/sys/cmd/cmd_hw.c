@@ -132,9 +132,7 @@ int cmd_hw(int argc, char **argv)
 			// Check correct number of arguments
 			if (argc != 3) return INVALID_ARGUMENTS;
 
-			encoder_find_z();
-
-			return SUCCESS;
+			return encoder_find_z();
 		}
 	}
 
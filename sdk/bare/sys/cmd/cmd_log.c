@@ -2,18 +2,39 @@
 #include "../commands.h"
 #include "../defines.h"
 #include "../log.h"
+#include "../log_stream.h"
+#include "../symbols.h"
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
 static command_entry_t cmd_entry;
 
-#define NUM_HELP_ENTRIES	(5)
+#define NUM_HELP_ENTRIES	(24)
 static command_help_t cmd_help[NUM_HELP_ENTRIES] = {
-		{"reg <log_var_idx> <name> <memory_addr> <samples_per_sec> <type>", "Register memory address for logging"},
-		{"start", "Start logging"},
+		{"reg <log_var_idx> <name> <symbol | memory_addr> <samples_per_sec> [type] [depth]", "Register exported variable (see 'sym list') or memory address for logging, keeping depth samples (default 10000); type is [u]int8/16/32/64, int, float or double"},
+		{"decim <log_var_idx> <none|mean|cic|env>", "Filter at the full log rate instead of sample-and-hold"},
+		{"compress <log_var_idx> <on|off>", "Delta-compress samples to fit more in the same memory"},
+		{"stats <log_var_idx> on [lo hi bins]", "Keep only mean / RMS / min / max (and a histogram) at full rate"},
+		{"stats <log_var_idx> off", "Store samples again"},
+		{"stats [log_var_idx]", "Display statistics (and histogram) of stats-only variables"},
+		{"info", "List registered variables and free log memory"},
+		{"reset", "Unregister all variables and free their log memory"},
+		{"trig <log_var_idx> <rising|falling> <level> <post_samples>", "Freeze logs post_samples after a threshold crossing"},
+		{"trig <log_var_idx> window <low> <high> <post_samples>", "Freeze logs post_samples after leaving a window"},
+		{"trig sw <post_samples>", "Freeze logs post_samples after 'log trig now'"},
+		{"trig now", "Fire the armed trigger"},
+		{"trig off", "Back to plain start / stop logging"},
+		{"group <samples_per_sec | now> <depth> <log_var_idx> ...", "Sample variables together, one timestamp per row ('now': on log_sample_now())"},
+		{"group off", "Sample grouped variables on their own again"},
+		{"group dma <on|off>", "Move group rows into the log with the DMA controller instead of the CPU"},
+		{"start", "Start logging (arms the trigger, if set)"},
 		{"stop", "Stop logging"},
 		{"dump <log_var_idx>", "Dump log data to console"},
+		{"dump bin <log_var_idx | group | all>", "Dump log data as binary frames (see tools/log2csv.py)"},
+		{"stream <samples_per_sec | now> <log_var_idx> ...", "Stream variables continuously as binary packets"},
+		{"stream stop", "Stop streaming"},
+		{"stream stats", "Display stream rate, sent and dropped rows"},
 		{"empty <log_var_idx>", "Empty log for a previously logged variable (stays registered)"}
 };
 
@@ -39,7 +60,10 @@ int cmd_log(int argc, char **argv)
 	// Handle 'reg' sub-command
 	if (strcmp("reg", argv[1]) == 0) {
 		// Check correct number of arguments
-		if (argc != 7) return INVALID_ARGUMENTS;
+		if (argc < 6 || argc > 8) return INVALID_ARGUMENTS;
+
+		// Buffers can't move while they are being filled
+		if (log_is_logging()) return FAILURE;
 
 		// Parse arg1: log_var_idx
 		int log_var_idx = atoi(argv[2]);
@@ -51,8 +75,22 @@ int cmd_log(int argc, char **argv)
 		// Parse arg2: name
 		char *name = argv[3];
 
-		// Parse arg3: memory_addr
-		void *memory_addr = (void *) atoi(argv[4]);
+		// Parse arg3: exported variable name, or memory_addr
+		// in decimal or 0x hex
+		void *memory_addr;
+		var_type_e type = 0;
+		const symbol_t *sym = symbol_find(argv[4]);
+		if (sym != NULL) {
+			memory_addr = sym->addr;
+			type = sym->type;
+		} else {
+			char *end;
+			memory_addr = (void *) (uintptr_t) strtoul(argv[4], &end, 0);
+			if (end == argv[4] || *end != '\0') {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+		}
 
 		// Parse arg4: samples_per_sec
 		int samples_per_sec = atoi(argv[5]);
@@ -61,24 +99,303 @@ int cmd_log(int argc, char **argv)
 			return INVALID_ARGUMENTS;
 		}
 
-		// Parse arg5: type
-		var_type_e type;
-		if (strcmp("int", argv[6]) == 0) {
-			type = INT;
-		} else if (strcmp("float", argv[6]) == 0) {
-			type = FLOAT;
-		} else if (strcmp("double", argv[6]) == 0) {
-			type = DOUBLE;
-		} else {
+		// Parse arg5: type, which an exported variable already has
+		int arg = 6;
+		var_type_e given = (arg < argc) ? log_type_from_name(argv[arg]) : 0;
+		if (given != 0) {
+			if (sym != NULL && given != type) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+
+			type = given;
+			arg++;
+		} else if (sym == NULL) {
 			// ERROR
 			return INVALID_ARGUMENTS;
 		}
 
+		// Parse arg6: depth
+		int depth = LOG_VARIABLE_SAMPLE_DEPTH;
+		if (arg < argc) {
+			depth = atoi(argv[arg]);
+			if (depth <= 0) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+			arg++;
+		}
+
+		if (arg != argc) return INVALID_ARGUMENTS;
+
 		// Register the variable with the logging engine
-		log_var_register(log_var_idx, name, memory_addr, samples_per_sec, type);
+		return log_var_register(log_var_idx, name, memory_addr, samples_per_sec, depth, type);
+	}
+
+	// Handle 'decim' sub-command
+	if (strcmp("decim", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 4) return INVALID_ARGUMENTS;
+
+		// Parse arg1: log_var_idx
+		int log_var_idx = atoi(argv[2]);
+		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		// Parse arg2: filter
+		log_decim_e decim;
+		if (strcmp("none", argv[3]) == 0) {
+			decim = LOG_DECIM_NONE;
+		} else if (strcmp("mean", argv[3]) == 0) {
+			decim = LOG_DECIM_MEAN;
+		} else if (strcmp("cic", argv[3]) == 0) {
+			decim = LOG_DECIM_CIC;
+		} else if (strcmp("env", argv[3]) == 0) {
+			decim = LOG_DECIM_ENVELOPE;
+		} else {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		return log_var_set_decim(log_var_idx, decim);
+	}
+
+	// Handle 'compress' sub-command
+	if (strcmp("compress", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 4) return INVALID_ARGUMENTS;
+
+		// Parse arg1: log_var_idx
+		int log_var_idx = atoi(argv[2]);
+		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		// Parse arg2: on / off
+		uint8_t enable;
+		if (strcmp("on", argv[3]) == 0) {
+			enable = 1;
+		} else if (strcmp("off", argv[3]) == 0) {
+			enable = 0;
+		} else {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		return log_var_set_compress(log_var_idx, enable);
+	}
+
+	// Handle 'stats' sub-command
+	if (strcmp("stats", argv[1]) == 0) {
+		if (argc == 2) {
+			return log_stats_print(-1);
+		}
+
+		// Parse arg1: log_var_idx
+		int log_var_idx = atoi(argv[2]);
+		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		if (argc == 3) {
+			return log_stats_print(log_var_idx);
+		}
+
+		if (argc == 4 && strcmp("off", argv[3]) == 0) {
+			return log_var_set_stats(log_var_idx, 0, 0.0, 0.0, 0);
+		}
+
+		if (strcmp("on", argv[3]) != 0) return INVALID_ARGUMENTS;
+
+		if (argc == 4) {
+			return log_var_set_stats(log_var_idx, 1, 0.0, 0.0, 0);
+		}
+
+		// Parse arg3..5: histogram range and bins
+		if (argc != 7) return INVALID_ARGUMENTS;
+
+		double lo = strtod(argv[4], NULL);
+		double hi = strtod(argv[5], NULL);
+		int bins = atoi(argv[6]);
+		if (bins <= 0 || bins > LOG_STATS_MAX_BINS || !(hi > lo)) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		return log_var_set_stats(log_var_idx, 1, lo, hi, bins);
+	}
+
+	// Handle 'info' sub-command
+	if (strcmp("info", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		log_info_print();
 		return SUCCESS;
 	}
 
+	// Handle 'reset' sub-command
+	if (strcmp("reset", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		return log_reset();
+	}
+
+	// Handle 'trig' sub-command
+	if (argc >= 3 && strcmp("trig", argv[1]) == 0) {
+		if (strcmp("now", argv[2]) == 0) {
+			if (argc != 3) return INVALID_ARGUMENTS;
+			return log_trigger();
+		}
+
+		if (strcmp("off", argv[2]) == 0) {
+			if (argc != 3) return INVALID_ARGUMENTS;
+			if (log_is_logging()) return FAILURE;
+
+			log_trig_off();
+			return SUCCESS;
+		}
+
+		if (strcmp("sw", argv[2]) == 0) {
+			if (argc != 4) return INVALID_ARGUMENTS;
+			return log_trig_set(LOG_TRIG_SOFTWARE, -1, 0.0, 0.0, atoi(argv[3]));
+		}
+
+		if (argc < 6) return INVALID_ARGUMENTS;
+
+		// Parse arg1: log_var_idx
+		int log_var_idx = atoi(argv[2]);
+		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		// Parse arg2: mode, then its levels and post_samples
+		if (strcmp("window", argv[3]) == 0) {
+			if (argc != 7) return INVALID_ARGUMENTS;
+			return log_trig_set(LOG_TRIG_WINDOW, log_var_idx, atof(argv[4]), atof(argv[5]), atoi(argv[6]));
+		}
+
+		if (argc != 6) return INVALID_ARGUMENTS;
+
+		log_trig_e mode;
+		if (strcmp("rising", argv[3]) == 0) {
+			mode = LOG_TRIG_RISING;
+		} else if (strcmp("falling", argv[3]) == 0) {
+			mode = LOG_TRIG_FALLING;
+		} else {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		return log_trig_set(mode, log_var_idx, atof(argv[4]), 0.0, atoi(argv[5]));
+	}
+
+	// Handle 'group' sub-command
+	if (argc >= 3 && strcmp("group", argv[1]) == 0) {
+		if (strcmp("off", argv[2]) == 0) {
+			if (argc != 3) return INVALID_ARGUMENTS;
+			return log_group_off();
+		}
+
+		if (strcmp("dma", argv[2]) == 0) {
+			if (argc != 4) return INVALID_ARGUMENTS;
+
+			// Parse arg2: on / off
+			uint8_t enable;
+			if (strcmp("on", argv[3]) == 0) {
+				enable = 1;
+			} else if (strcmp("off", argv[3]) == 0) {
+				enable = 0;
+			} else {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+
+			return log_group_set_dma(enable);
+		}
+
+		if (argc < 5) return INVALID_ARGUMENTS;
+
+		// Parse arg1: samples_per_sec
+		int samples_per_sec = 0;
+		if (strcmp("now", argv[2]) != 0) {
+			samples_per_sec = atoi(argv[2]);
+			if (samples_per_sec > LOG_UPDATES_PER_SEC || samples_per_sec <= 0) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+		}
+
+		// Parse arg2: depth
+		int depth = atoi(argv[3]);
+		if (depth <= 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		// Parse remaining args: log_var_idx of each channel
+		int idxs[LOG_GROUP_MAX_CHANNELS];
+		int num_channels = argc - 4;
+		if (num_channels > LOG_GROUP_MAX_CHANNELS) return INVALID_ARGUMENTS;
+
+		for (int c = 0; c < num_channels; c++) {
+			idxs[c] = atoi(argv[4 + c]);
+			if (idxs[c] >= LOG_MAX_NUM_VARS || idxs[c] < 0) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+		}
+
+		return log_group_set(samples_per_sec, depth, idxs, num_channels);
+	}
+
+	// Handle 'stream' sub-command
+	if (argc >= 3 && strcmp("stream", argv[1]) == 0) {
+		if (strcmp("stop", argv[2]) == 0) {
+			if (argc != 3) return INVALID_ARGUMENTS;
+			return log_stream_stop();
+		}
+
+		if (strcmp("stats", argv[2]) == 0) {
+			if (argc != 3) return INVALID_ARGUMENTS;
+			log_stream_stats_print();
+			return SUCCESS;
+		}
+
+		if (argc < 4) return INVALID_ARGUMENTS;
+
+		// Parse arg1: samples_per_sec
+		int samples_per_sec = 0;
+		if (strcmp("now", argv[2]) != 0) {
+			samples_per_sec = atoi(argv[2]);
+			if (samples_per_sec > LOG_UPDATES_PER_SEC || samples_per_sec <= 0) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+		}
+
+		// Parse remaining args: log_var_idx of each channel
+		int idxs[LOG_STREAM_MAX_CHANNELS];
+		int num_channels = argc - 3;
+		if (num_channels > LOG_STREAM_MAX_CHANNELS) return INVALID_ARGUMENTS;
+
+		for (int c = 0; c < num_channels; c++) {
+			idxs[c] = atoi(argv[3 + c]);
+			if (idxs[c] >= LOG_MAX_NUM_VARS || idxs[c] < 0) {
+				// ERROR
+				return INVALID_ARGUMENTS;
+			}
+		}
+
+		return log_stream_start(samples_per_sec, idxs, num_channels);
+	}
+
 	// Handle 'start' sub-command
 	if (strcmp("start", argv[1]) == 0) {
 		// Check correct number of arguments
@@ -103,6 +420,29 @@ int cmd_log(int argc, char **argv)
 		return SUCCESS;
 	}
 
+	// Handle 'dump bin' sub-command
+	if (argc == 4 && strcmp("dump", argv[1]) == 0 && strcmp("bin", argv[2]) == 0) {
+		// Ensure logging was stopped before this
+		if (log_is_logging()) return FAILURE;
+
+		// Parse arg1: log_var_idx
+		if (strcmp("all", argv[3]) == 0) {
+			return log_var_dump_uart_binary(LOG_DUMP_ALL);
+		}
+
+		if (strcmp("group", argv[3]) == 0) {
+			return log_var_dump_uart_binary(LOG_DUMP_GROUP);
+		}
+
+		int log_var_idx = atoi(argv[3]);
+		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
+			// ERROR
+			return INVALID_ARGUMENTS;
+		}
+
+		return log_var_dump_uart_binary(log_var_idx);
+	}
+
 	// Handle 'dump' sub-command
 	if (strcmp("dump", argv[1]) == 0) {
 		// Check correct number of arguments
@@ -118,8 +458,7 @@ int cmd_log(int argc, char **argv)
 			return INVALID_ARGUMENTS;
 		}
 
-		log_var_dump_uart(log_var_idx);
-		return SUCCESS;
+		return log_var_dump_uart(log_var_idx);
 	}
 
 	// Handle 'empty' sub-command
@@ -127,6 +466,9 @@ int cmd_log(int argc, char **argv)
 		// Check correct number of arguments
 		if (argc != 3) return INVALID_ARGUMENTS;
 
+		// Buffers can't be reset while being filled or dumped
+		if (log_is_logging() || log_dump_is_active()) return FAILURE;
+
 		// Parse arg1: log_var_idx
 		int log_var_idx = atoi(argv[2]);
 		if (log_var_idx >= LOG_MAX_NUM_VARS || log_var_idx < 0) {
@@ -0,0 +1,92 @@
+#include "cmd_sched.h"
+#include "../commands.h"
+#include "../debug.h"
+#include "../defines.h"
+#include "../scheduler.h"
+#include <stdint.h>
+#include <string.h>
+
+static command_entry_t cmd_entry;
+
+#define NUM_HELP_ENTRIES	(5)
+static command_help_t cmd_help[NUM_HELP_ENTRIES] = {
+		{"stats", "Display execution time of each task"},
+		{"stats reset", "Reset task execution time and jitter statistics"},
+		{"load", "Display CPU load and worst-case busy time per tick"},
+		{"jitter <task_name>", "Display start latency percentiles of a task"},
+		{"mode <list|table>", "Walk task list or use precomputed schedule table"}
+};
+
+void cmd_sched_register(void)
+{
+	// Populate the command entry block
+	commands_cmd_init(&cmd_entry,
+			"sched", "Scheduler commands",
+			cmd_help, NUM_HELP_ENTRIES,
+			cmd_sched
+	);
+
+	// Register the command
+	commands_cmd_register(&cmd_entry);
+}
+
+//
+// Handles the 'sched' command
+// and all sub-commands
+//
+int cmd_sched(int argc, char **argv)
+{
+	// Handle 'stats' sub-command
+	if (argc >= 2 && strcmp("stats", argv[1]) == 0) {
+		if (argc == 2) {
+			scheduler_stats_print();
+			return SUCCESS;
+		}
+
+		if (argc == 3 && strcmp("reset", argv[2]) == 0) {
+			scheduler_stats_reset();
+			return SUCCESS;
+		}
+	}
+
+	// Handle 'load' sub-command
+	if (argc >= 2 && strcmp("load", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		debug_printf("CPU load: %.1f%%\r\n", scheduler_get_cpu_load());
+		debug_printf("Max busy per tick: %.2f / %d usec\r\n",
+				scheduler_get_max_busy_usec(), SYS_TICK_USEC);
+		return SUCCESS;
+	}
+
+	// Handle 'jitter' sub-command
+	if (argc >= 2 && strcmp("jitter", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 3) return INVALID_ARGUMENTS;
+
+		task_control_block_t *tcb = scheduler_find_task(argv[2]);
+		if (tcb == NULL) return INVALID_ARGUMENTS;
+
+		scheduler_jitter_print(tcb);
+		return SUCCESS;
+	}
+
+	// Handle 'mode' sub-command
+	if (argc >= 2 && strcmp("mode", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 3) return INVALID_ARGUMENTS;
+
+		if (strcmp("list", argv[2]) == 0) {
+			scheduler_set_mode(SCHED_MODE_LIST);
+			return SUCCESS;
+		}
+
+		if (strcmp("table", argv[2]) == 0) {
+			scheduler_set_mode(SCHED_MODE_TABLE);
+			return SUCCESS;
+		}
+	}
+
+	return INVALID_ARGUMENTS;
+}
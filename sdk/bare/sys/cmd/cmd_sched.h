@@ -0,0 +1,8 @@
+#ifndef CMD_SCHED_H
+#define CMD_SCHED_H
+
+void cmd_sched_register(void);
+
+int cmd_sched(int argc, char **argv);
+
+#endif // CMD_SCHED_H
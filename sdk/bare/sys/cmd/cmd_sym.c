@@ -0,0 +1,104 @@
+#include "cmd_sym.h"
+#include "../commands.h"
+#include "../debug.h"
+#include "../defines.h"
+#include "../symbols.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+static command_entry_t cmd_entry;
+
+#define NUM_HELP_ENTRIES	(3)
+static command_help_t cmd_help[NUM_HELP_ENTRIES] = {
+		{"list", "List exported variables"},
+		{"get <name>", "Display value of exported variable"},
+		{"set <name> <value>", "Write value to exported variable"}
+};
+
+void cmd_sym_register(void)
+{
+	// Populate the command entry block
+	commands_cmd_init(&cmd_entry,
+			"sym", "Exported variable commands",
+			cmd_help, NUM_HELP_ENTRIES,
+			cmd_sym
+	);
+
+	// Register the command
+	commands_cmd_register(&cmd_entry);
+}
+
+// Writes 'arg' to the variable at its own width
+static int _write_value(const symbol_t *sym, const char *arg)
+{
+	int64_t i = strtoll(arg, NULL, 0);
+	uint64_t u = strtoull(arg, NULL, 0);
+	double d = strtod(arg, NULL);
+
+	switch (sym->type) {
+	case INT8:		*((int8_t *) sym->addr) = (int8_t) i;		break;
+	case UINT8:		*((uint8_t *) sym->addr) = (uint8_t) u;		break;
+	case INT16:		*((int16_t *) sym->addr) = (int16_t) i;		break;
+	case UINT16:	*((uint16_t *) sym->addr) = (uint16_t) u;	break;
+	case INT:		*((int32_t *) sym->addr) = (int32_t) i;		break;
+	case UINT32:	*((uint32_t *) sym->addr) = (uint32_t) u;	break;
+	case INT64:		*((int64_t *) sym->addr) = i;				break;
+	case UINT64:	*((uint64_t *) sym->addr) = u;				break;
+	case FLOAT:		*((float *) sym->addr) = (float) d;			break;
+	case DOUBLE:	*((double *) sym->addr) = d;				break;
+	default:
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+//
+// Handles the 'sym' command
+// and all sub-commands
+//
+int cmd_sym(int argc, char **argv)
+{
+	if (argc < 2) return INVALID_ARGUMENTS;
+
+	// Handle 'list' sub-command
+	if (strcmp("list", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		for (int i = 0; i < symbols_count(); i++) {
+			const symbol_t *sym = symbol_get(i);
+			debug_printf("%-24s%s\t%p\r\n", sym->name, log_type_get_name(sym->type), sym->addr);
+		}
+
+		return SUCCESS;
+	}
+
+	// Handle 'get' sub-command
+	if (strcmp("get", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 3) return INVALID_ARGUMENTS;
+
+		const symbol_t *sym = symbol_find(argv[2]);
+		if (sym == NULL) return INVALID_ARGUMENTS;
+
+		debug_printf("%s = ", sym->name);
+		log_value_print(sym->type, sym->addr);
+		debug_printf("\r\n");
+		return SUCCESS;
+	}
+
+	// Handle 'set' sub-command
+	if (strcmp("set", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 4) return INVALID_ARGUMENTS;
+
+		const symbol_t *sym = symbol_find(argv[2]);
+		if (sym == NULL) return INVALID_ARGUMENTS;
+
+		return _write_value(sym, argv[3]);
+	}
+
+	return INVALID_ARGUMENTS;
+}
@@ -0,0 +1,8 @@
+#ifndef CMD_SYM_H
+#define CMD_SYM_H
+
+void cmd_sym_register(void);
+
+int cmd_sym(int argc, char **argv);
+
+#endif // CMD_SYM_H
@@ -0,0 +1,95 @@
+#include "cmd_trace.h"
+#include "../commands.h"
+#include "../defines.h"
+#include "../trace.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+static command_entry_t cmd_entry;
+
+#define NUM_HELP_ENTRIES	(5)
+static command_help_t cmd_help[NUM_HELP_ENTRIES] = {
+		{"start", "Start recording events"},
+		{"stop", "Stop recording events"},
+		{"clear", "Discard recorded events"},
+		{"mark <id>", "Record a user marker"},
+		{"dump", "Stream raw trace buffer to console"}
+};
+
+void cmd_trace_register(void)
+{
+	// Populate the command entry block
+	commands_cmd_init(&cmd_entry,
+			"trace", "Event trace recorder commands",
+			cmd_help, NUM_HELP_ENTRIES,
+			cmd_trace
+	);
+
+	// Register the command
+	commands_cmd_register(&cmd_entry);
+}
+
+//
+// Handles the 'trace' command
+// and all sub-commands
+//
+int cmd_trace(int argc, char **argv)
+{
+	if (argc < 2) return INVALID_ARGUMENTS;
+
+	// Handle 'start' sub-command
+	if (strcmp("start", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		// Make sure trace was stopped before this
+		if (trace_is_running()) return FAILURE;
+
+		trace_start();
+		return SUCCESS;
+	}
+
+	// Handle 'stop' sub-command
+	if (strcmp("stop", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		// Make sure trace was running before this
+		if (!trace_is_running()) return FAILURE;
+
+		trace_stop();
+		return SUCCESS;
+	}
+
+	// Handle 'clear' sub-command
+	if (strcmp("clear", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		trace_clear();
+		return SUCCESS;
+	}
+
+	// Handle 'mark' sub-command
+	if (strcmp("mark", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 3) return INVALID_ARGUMENTS;
+
+		trace_mark((uint16_t) atoi(argv[2]));
+		return SUCCESS;
+	}
+
+	// Handle 'dump' sub-command
+	if (strcmp("dump", argv[1]) == 0) {
+		// Check correct number of arguments
+		if (argc != 2) return INVALID_ARGUMENTS;
+
+		// Ensure tracing was stopped before this
+		if (trace_is_running()) return FAILURE;
+
+		return trace_dump_uart();
+	}
+
+	return INVALID_ARGUMENTS;
+}
@@ -0,0 +1,8 @@
+#ifndef CMD_TRACE_H
+#define CMD_TRACE_H
+
+void cmd_trace_register(void);
+
+int cmd_trace(int argc, char **argv);
+
+#endif // CMD_TRACE_H
@@ -1,9 +1,12 @@
 #include "commands.h"
 #include "debug.h"
 #include "defines.h"
+#include "event.h"
+#include "job.h"
 #include "log.h"
 #include "scheduler.h"
 #include "serial.h"
+#include "trace.h"
 #include "cmd/cmd_help.h"
 #include "../drv/encoder.h"
 #include "../drv/uart.h"
@@ -16,7 +19,7 @@ static char recv_buffer[RECV_BUFFER_LENGTH] = {0};
 static int recv_buffer_idx = 0;
 
 #define CMD_MAX_ARGC			(16) // # of args accepted
-#define CMD_MAX_ARG_LENGTH		(16) // max chars of any arg
+#define CMD_MAX_ARG_LENGTH		(32) // max chars of any arg, fits exported symbol names
 typedef struct pending_cmd_t {
 	int argc;
 	char *argv[CMD_MAX_ARGC];
@@ -49,20 +52,30 @@ static int _command_handler(int argc, char **argv);
 // Head of linked list of commands
 command_entry_t *cmds = NULL;
 
+// Number of registered commands, used as trace IDs
+static int num_cmds = 0;
+
 static task_control_block_t tcb_parse;
 static task_control_block_t tcb_exec;
 
+// Posted when a parsed command is ready to execute
+static event_t cmd_ready_event;
+
 void commands_init(void)
 {
 	printf("CMD:\tInitializing command tasks...\n");
 
-	// Command parse task
-	scheduler_tcb_init(&tcb_parse, commands_callback_parse, NULL, "command_parse", COMMANDS_INTERVAL_USEC);
-	scheduler_tcb_register(&tcb_parse);
+	cmd_ready_event = event_create();
 
-	// Command exec task
-	scheduler_tcb_init(&tcb_exec, commands_callback_exec, NULL, "command_exec", COMMANDS_INTERVAL_USEC);
-	scheduler_tcb_register(&tcb_exec);
+	// Command parse task, runs when the UART received data
+	scheduler_tcb_init(&tcb_parse, commands_callback_parse, NULL, "command_parse", 0);
+	scheduler_tcb_set_criticality(&tcb_parse, TASK_NON_CRITICAL);
+	scheduler_tcb_register_event(&tcb_parse, uart_get_rx_event());
+
+	// Command exec task, runs when a command was parsed
+	scheduler_tcb_init(&tcb_exec, commands_callback_exec, NULL, "command_exec", 0);
+	scheduler_tcb_set_criticality(&tcb_exec, TASK_NON_CRITICAL);
+	scheduler_tcb_register_event(&tcb_exec, cmd_ready_event);
 
 	cmd_help_register();
 }
@@ -100,6 +113,7 @@ void _create_pending_cmds(char *buffer, int length)
 			debug_printf("\r\n");
 
 			p->ready = 1;
+			event_post(cmd_ready_event);
 
 			// Update current pending cmd slot
 			if (++pending_cmd_write_idx >= MAX_PENDING_CMDS) pending_cmd_write_idx = 0;
@@ -252,6 +266,11 @@ void commands_callback_exec(void *arg)
 		if (++pending_cmd_read_idx >= MAX_PENDING_CMDS) {
 			pending_cmd_read_idx = 0;
 		}
+
+		// Run again next time slice if more commands are queued
+		if (pending_cmds[pending_cmd_read_idx].ready) {
+			event_post(cmd_ready_event);
+		}
 	}
 }
 
@@ -271,6 +290,9 @@ void commands_cmd_init(command_entry_t *cmd_entry,
 
 void commands_cmd_register(command_entry_t *cmd_entry)
 {
+	// Commands are traced by their position in the list
+	trace_name(TRACE_CMD_BEGIN, num_cmds++, cmd_entry->cmd);
+
 	// Base case: there are no tasks in linked list
 	if (cmds == NULL) {
 		cmds = cmd_entry;
@@ -301,14 +323,19 @@ void commands_start_msg(void)
 int _command_handler(int argc, char **argv)
 {
 	command_entry_t *c = cmds;
+	int id = 0;
 
 	while (c != NULL) {
 		if (strcmp(argv[0], c->cmd) == 0) {
 			// Found command to run!
-			return c->cmd_function(argc, argv);
+			trace_record(TRACE_CMD_BEGIN, id);
+			int err = c->cmd_function(argc, argv);
+			trace_record(TRACE_CMD_END, id);
+			return err;
 		}
 
 		c = c->next;
+		id++;
 	}
 
 	return UNKNOWN_CMD;
@@ -325,24 +352,27 @@ typedef enum sm_states_e {
 	TITLE2,
 	TITLE3,
 	CMD_HEADER,
-	SUB_CMD,
-	REMOVE_TASK
+	SUB_CMD
 } sm_states_e;
 
 typedef struct sm_ctx_t {
 	sm_states_e state;
 	command_entry_t *curr;
 	int sub_cmd_idx;
-	task_control_block_t tcb;
+	job_t job;
 } sm_ctx_t;
 
-#define SM_UPDATES_PER_SEC		(10000)
-#define SM_INTERVAL_USEC		(USEC_IN_SEC / SM_UPDATES_PER_SEC)
+#define MSG_LENGTH		(128)
 
-void help_state_machine_callback(void *arg)
+static job_status_e _help_step(void *arg)
 {
 	sm_ctx_t *ctx = (sm_ctx_t *) arg;
 
+	// Wait for UART to drain so no output is lost
+	if (serial_get_free_space() < MSG_LENGTH) {
+		return JOB_YIELD;
+	}
+
 	switch (ctx->state) {
 	case TITLE1:
 		debug_printf("\r\n");
@@ -365,7 +395,7 @@ void help_state_machine_callback(void *arg)
 		if (ctx->curr == NULL) {
 			// DONE!
 			debug_printf("\r\n");
-			ctx->state = REMOVE_TASK;
+			return JOB_DONE;
 		} else {
 			debug_printf("%s -- %s\r\n", ctx->curr->cmd, ctx->curr->desc);
 			ctx->sub_cmd_idx = 0;
@@ -383,27 +413,30 @@ void help_state_machine_callback(void *arg)
 		}
 		break;
 
-	case REMOVE_TASK:
-		scheduler_tcb_unregister(&ctx->tcb);
-		break;
-
 	default:
 		// Can't happen
 		HANG;
 		break;
 	}
+
+	return JOB_CONTINUE;
 }
 
 static sm_ctx_t ctx;
 
-void commands_display_help(void)
+int commands_display_help(void)
 {
+	// Only one help message can print at a time
+	if (job_is_active(&ctx.job)) {
+		return FAILURE;
+	}
+
 	// Initialize the state machine context
 	ctx.state = TITLE1;
 	ctx.curr = cmds;
 	ctx.sub_cmd_idx = 0;
 
-	// Initialize the state machine callback tcb
-	scheduler_tcb_init(&ctx.tcb, help_state_machine_callback, &ctx, "help_sm", SM_INTERVAL_USEC);
-	scheduler_tcb_register(&ctx.tcb);
+	// Print in the slack of each time slice
+	job_init(&ctx.job, _help_step, &ctx, "help");
+	return job_start(&ctx.job);
 }
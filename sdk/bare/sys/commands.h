@@ -3,9 +3,6 @@
 
 #include "../sys/defines.h"
 
-#define COMMANDS_UPDATES_PER_SEC	(10000)
-#define COMMANDS_INTERVAL_USEC		(USEC_IN_SEC / COMMANDS_UPDATES_PER_SEC)
-
 // Forward declarations
 typedef struct command_entry_t command_entry_t;
 typedef struct command_help_t command_help_t;
@@ -39,6 +36,6 @@ void commands_cmd_init(command_entry_t *cmd_entry,
 void commands_cmd_register(command_entry_t *cmd_entry);
 
 void commands_start_msg(void);
-void commands_display_help(void);
+int commands_display_help(void);
 
 #endif // COMMANDS_H
@@ -0,0 +1,35 @@
+#include "crc32.h"
+
+#define CRC32_POLY	(0xEDB88320)
+
+static uint32_t table[256];
+static uint8_t table_ready = 0;
+
+static void _build_table(void)
+{
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for (int k = 0; k < 8; k++) {
+			c = (c & 1) ? (CRC32_POLY ^ (c >> 1)) : (c >> 1);
+		}
+		table[i] = c;
+	}
+
+	table_ready = 1;
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, int len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+
+	if (!table_ready) {
+		_build_table();
+	}
+
+	crc = ~crc;
+	for (int i = 0; i < len; i++) {
+		crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
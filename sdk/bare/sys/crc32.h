@@ -0,0 +1,15 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, as used by zlib / Python's zlib.crc32)
+//
+// Start with crc = 0 and feed data in as many pieces as needed:
+//
+// uint32_t crc = crc32_update(0, a, len_a);
+// crc = crc32_update(crc, b, len_b);
+//
+uint32_t crc32_update(uint32_t crc, const void *data, int len);
+
+#endif // CRC32_H
@@ -0,0 +1,27 @@
+#include "event.h"
+#include "defines.h"
+#include <stdio.h>
+
+static int num_events = 0;
+
+static volatile event_t pending = 0;
+
+event_t event_create(void)
+{
+	// Out of event bits
+	if (num_events >= EVENT_MAX_EVENTS) {
+		HANG;
+	}
+
+	return (event_t) 1 << num_events++;
+}
+
+void event_post(event_t events)
+{
+	__atomic_fetch_or(&pending, events, __ATOMIC_RELEASE);
+}
+
+event_t event_take(void)
+{
+	return __atomic_exchange_n(&pending, 0, __ATOMIC_ACQUIRE);
+}
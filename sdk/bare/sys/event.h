@@ -0,0 +1,30 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+// Events
+//
+// An event is one bit in a set of pending flags. ISRs and tasks post
+// events; tasks registered with scheduler_tcb_register_event() run in
+// the next time slice after one of their events was posted, instead
+// of polling at a fixed interval.
+//
+// Posting is lock-free and safe from any context. Posting an event
+// which is already pending does nothing, so a task runs once per
+// slice no matter how often its event was posted.
+//
+#define EVENT_MAX_EVENTS	(32)
+
+// Set of events, one bit each
+typedef uint32_t event_t;
+
+// Allocates a new event; call during init only
+event_t event_create(void);
+
+void event_post(event_t events);
+
+// Clears and returns all pending events
+event_t event_take(void);
+
+#endif // EVENT_H
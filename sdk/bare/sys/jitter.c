@@ -0,0 +1,72 @@
+#include "jitter.h"
+#include <string.h>
+
+#define MAX_TICKS	((1 << JITTER_MAX_BITS) - 1)
+
+static inline int _bin(uint32_t ticks)
+{
+	if (ticks > MAX_TICKS) {
+		ticks = MAX_TICKS;
+	}
+
+	// Small values get one bin each
+	if (ticks < JITTER_SUB_BINS) {
+		return ticks;
+	}
+
+	// Otherwise, octave from the leading one bit,
+	// sub-bin from the next JITTER_SUB_BITS bits
+	int msb = 31 - __builtin_clz(ticks);
+	int shift = msb - JITTER_SUB_BITS;
+	return ((shift + 1) << JITTER_SUB_BITS) + ((ticks >> shift) & (JITTER_SUB_BINS - 1));
+}
+
+// Smallest latency which falls in 'bin'
+static uint32_t _bin_lower(int bin)
+{
+	if (bin < JITTER_SUB_BINS) {
+		return bin;
+	}
+
+	int shift = (bin >> JITTER_SUB_BITS) - 1;
+	uint32_t sub = bin & (JITTER_SUB_BINS - 1);
+	return (JITTER_SUB_BINS + sub) << shift;
+}
+
+void jitter_reset(jitter_hist_t *hist)
+{
+	memset(hist, 0, sizeof(jitter_hist_t));
+}
+
+void jitter_record(jitter_hist_t *hist, uint32_t ticks)
+{
+	hist->bins[_bin(ticks)]++;
+	hist->num_samples++;
+
+	if (ticks > hist->max_ticks) {
+		hist->max_ticks = ticks;
+	}
+}
+
+uint32_t jitter_percentile(jitter_hist_t *hist, double percent)
+{
+	if (hist->num_samples == 0) {
+		return 0;
+	}
+
+	// Number of samples which must be at or below the result
+	uint32_t target = (uint32_t) ((percent / 100.0) * (double) hist->num_samples);
+	if (target == 0) target = 1;
+
+	uint32_t count = 0;
+	for (int bin = 0; bin < JITTER_NUM_BINS; bin++) {
+		count += hist->bins[bin];
+		if (count >= target) {
+			// Report bin upper edge, but never more than the true max
+			uint32_t upper = (bin + 1 < JITTER_NUM_BINS) ? _bin_lower(bin + 1) - 1 : hist->max_ticks;
+			return (upper < hist->max_ticks) ? upper : hist->max_ticks;
+		}
+	}
+
+	return hist->max_ticks;
+}
@@ -0,0 +1,30 @@
+#ifndef JITTER_H
+#define JITTER_H
+
+#include <stdint.h>
+
+// Task start latency histogram
+//
+// Latencies are in CPU timer ticks (see drv/cpu_timer.h). Bins are
+// log-linear: 8 bins per power of two, so each bin is at most 12.5%
+// wide relative to its value. Latencies up to 2^JITTER_MAX_BITS ticks
+// (~3 ms) are resolved; anything longer lands in the last bin.
+//
+#define JITTER_SUB_BITS			(3)
+#define JITTER_SUB_BINS			(1 << JITTER_SUB_BITS)
+#define JITTER_MAX_BITS			(20)
+#define JITTER_NUM_BINS			(JITTER_SUB_BINS * (JITTER_MAX_BITS - JITTER_SUB_BITS + 1))
+
+typedef struct jitter_hist_t {
+	uint32_t bins[JITTER_NUM_BINS];
+	uint32_t num_samples;
+	uint32_t max_ticks;
+} jitter_hist_t;
+
+void jitter_reset(jitter_hist_t *hist);
+void jitter_record(jitter_hist_t *hist, uint32_t ticks);
+
+// Returns latency (ticks) below which 'percent' of the samples fall
+uint32_t jitter_percentile(jitter_hist_t *hist, double percent);
+
+#endif // JITTER_H
@@ -0,0 +1,95 @@
+#include "job.h"
+#include "defines.h"
+#include "../drv/cpu_timer.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Linked list of active jobs
+static job_t *jobs = NULL;
+
+void job_init(job_t *job, job_step_t step, void *step_arg, const char *name)
+{
+	job->name = name;
+	job->step = step;
+	job->step_arg = step_arg;
+	job->budget_ticks = 0;
+	job->active = 0;
+	job->next = NULL;
+}
+
+void job_set_budget_usec(job_t *job, uint32_t budget_usec)
+{
+	job->budget_ticks = budget_usec * CPU_TIMER_TICKS_PER_USEC;
+}
+
+int job_start(job_t *job)
+{
+	// Don't let clients start a job twice
+	if (job->active) {
+		return FAILURE;
+	}
+
+	job->active = 1;
+	job->next = NULL;
+
+	// Base case: there are no jobs in linked list
+	if (jobs == NULL) {
+		jobs = job;
+		return SUCCESS;
+	}
+
+	// Append new job to end of list
+	job_t *curr = jobs;
+	while (curr->next != NULL) curr = curr->next;
+	curr->next = job;
+
+	return SUCCESS;
+}
+
+uint8_t job_is_active(job_t *job)
+{
+	return job->active;
+}
+
+static inline bool _out_of_time(uint32_t start, uint32_t budget_ticks)
+{
+	return (cpu_timer_now() - start) >= budget_ticks;
+}
+
+void job_run(uint32_t start, uint32_t budget_ticks)
+{
+	job_t *prev = NULL;
+	job_t *j = jobs;
+
+	while (j != NULL && !_out_of_time(start, budget_ticks)) {
+		uint32_t job_start_ticks = cpu_timer_now();
+		job_status_e status;
+
+		// Step until the job yields, finishes, or runs out of time
+		do {
+			status = j->step(j->step_arg);
+
+			if (j->budget_ticks > 0 && _out_of_time(job_start_ticks, j->budget_ticks)) {
+				break;
+			}
+		} while (status == JOB_CONTINUE && !_out_of_time(start, budget_ticks));
+
+		job_t *next = j->next;
+
+		if (status == JOB_DONE) {
+			// Remove job from list
+			if (prev == NULL) {
+				jobs = next;
+			} else {
+				prev->next = next;
+			}
+
+			j->active = 0;
+			j->next = NULL;
+		} else {
+			prev = j;
+		}
+
+		j = next;
+	}
+}
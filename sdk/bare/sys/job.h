@@ -0,0 +1,54 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include <stdint.h>
+
+// Chunked jobs
+//
+// A job is long-running background work (dumping a log, printing the help
+// message, etc) split into small resumable steps. After all tasks in a
+// time slice have run, the scheduler spends the slack left in the slice
+// calling job steps, instead of pacing the work at a fixed rate.
+//
+// Each step must be short (a few usec) and return:
+//
+// JOB_CONTINUE -- more work to do, call again as soon as there is time
+// JOB_YIELD    -- waiting on something (e.g. UART space), retry next slice
+// JOB_DONE     -- finished, job is removed
+//
+
+// Time kept free at the end of each slice, as a job
+// step might already be running when the deadline hits
+#define JOB_SLACK_MARGIN_USEC	(10)
+
+typedef enum job_status_e {
+	JOB_CONTINUE = 1,
+	JOB_YIELD,
+	JOB_DONE
+} job_status_e;
+
+typedef job_status_e (*job_step_t)(void *);
+
+typedef struct job_t {
+	const char *name;
+	job_step_t step;
+	void *step_arg;
+
+	// Max CPU timer ticks per slice, or 0 to use all the slack
+	uint32_t budget_ticks;
+
+	uint8_t active;
+	struct job_t *next;
+} job_t;
+
+void job_init(job_t *job, job_step_t step, void *step_arg, const char *name);
+void job_set_budget_usec(job_t *job, uint32_t budget_usec);
+
+// Queues the job; returns FAILURE if it is already running
+int job_start(job_t *job);
+uint8_t job_is_active(job_t *job);
+
+// Runs job steps until 'budget_ticks' CPU timer ticks after 'start'
+void job_run(uint32_t start, uint32_t budget_ticks);
+
+#endif // JOB_H
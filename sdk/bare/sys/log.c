@@ -1,144 +1,1499 @@
 #include "log.h"
+#include "log_stream.h"
+#include "crc32.h"
 #include "debug.h"
 #include "defines.h"
+#include "job.h"
 #include "scheduler.h"
+#include "serial.h"
 #include "cmd/cmd_log.h"
+#include "../drv/cpu_timer.h"
+#include "../drv/dma.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <math.h>
 
-#define LOG_BUFFER_LENGTH	(LOG_VARIABLE_SAMPLE_DEPTH * sizeof(buffer_entry_t))
+// Compressed variables keep their samples in a ring of fixed size
+// blocks instead of arrays. Each block starts with its first sample
+// in full, so it decodes on its own after older blocks are reused;
+// every later sample is two zig-zag varints: the timestamp's offset
+// from the nominal interval and the change of the value's bits.
+// Values are handled as little-endian bits, sign-extended for signed
+// types, so a slowly moving signal costs 2 or 3 bytes per sample
+typedef struct pack_block_t {
+	uint64_t bits;			// first sample
+	uint32_t timestamp;
+	uint16_t num_samples;
+	uint16_t num_bytes;		// of varints after the header
+} pack_block_t;
+
+#define PACK_BLOCK_BYTES		(256)
+#define PACK_PAYLOAD_BYTES		(PACK_BLOCK_BYTES - sizeof(pack_block_t))
 
-#define LOG_VAR_NAME_MAX_CHARS	(16)
+// Worst case: 32-bit and 64-bit varints
+#define PACK_MAX_SAMPLE_BYTES	(5 + 10)
 
-typedef struct buffer_entry_t {
+// Position of the next sample to decode
+typedef struct pack_cursor_t {
+	int block;
+	int sample;
+	int offset;
 	uint32_t timestamp;
-	uint32_t value;
-} buffer_entry_t;
+	uint64_t bits;
+} pack_cursor_t;
+
+// Running statistics of a stats-only variable
+typedef struct log_stats_t {
+	uint64_t count;
+	double sum;
+	double sumsq;
+	double min;
+	double max;
+
+	// Optional histogram of [lo, hi), plus the
+	// samples which fell below and above it
+	int num_bins;
+	double lo;
+	double hi;
+	uint32_t below;
+	uint32_t above;
+	uint32_t bins[LOG_STATS_MAX_BINS];
+} log_stats_t;
 
 typedef struct log_var_t {
 	char name[LOG_VAR_NAME_MAX_CHARS];
 	void *addr;
 	var_type_e type;
 
-	uint32_t log_interval_usec;
-	uint64_t last_logged_usec;
+	uint32_t log_interval_usec;
+	uint64_t last_logged_usec;
+
+	int num_samples;
+	int buffer_idx;
+
+	// Samples kept, bytes per stored value, and bytes the block
+	// in the arena can hold. The block is split into arrays of
+	// timestamps, values, then mins and maxs (envelope only)
+	int depth;
+	int width;
+	uint32_t capacity;
+	uint32_t *timestamps;
+	uint8_t *values;
+	uint8_t *mins;
+	uint8_t *maxs;
+
+	// Decimation stage, fed every log tick. 'acc' is the sum (mean)
+	// or the weighted sum of the current output (CIC), 'acc_next'
+	// the CIC weighted sum already due to the next output
+	log_decim_e decim;
+	int decim_ratio;
+	int decim_count;
+	double acc;
+	double acc_next;
+	double min;
+	double max;
+
+	// Compressed, so the arena block is a ring of pack blocks,
+	// written at 'head_block' and oldest at 'tail_block'
+	uint8_t packed;
+	int num_blocks;
+	int head_block;
+	int tail_block;
+	uint32_t last_timestamp;
+	uint64_t last_bits;
+
+	// Only statistics are kept, no samples
+	uint8_t stats_only;
+	log_stats_t stats;
+
+	// Sampled as a channel of the group instead of on its own
+	uint8_t in_group;
+
+	// Samples still to take after the trigger fired; -1 before
+	// the trigger, 0 once the buffer is frozen
+	int post_left;
+} log_var_t;
+
+static log_var_t vars[LOG_MAX_NUM_VARS] = {0};
+
+// Group of variables sampled together into one block of rows,
+// stored as arrays: timestamps[depth], seqs[depth], then
+// values[depth] for each channel at its own width.
+//
+// With DMA capture the block holds whole rows instead, as staged:
+// timestamp, seq, then the values packed at 'offsets', padded to 4
+typedef struct log_group_t {
+	int num_channels;
+	uint8_t channels[LOG_GROUP_MAX_CHANNELS];
+
+	// 0 when only sampled by log_sample_now()
+	uint32_t log_interval_usec;
+	uint64_t last_logged_usec;
+
+	uint32_t *block;
+	uint32_t capacity;
+	int depth;
+	uint32_t *seqs;
+	uint8_t *values[LOG_GROUP_MAX_CHANNELS];
+	uint8_t widths[LOG_GROUP_MAX_CHANNELS];
+
+	// DMA capture: rows start cache line aligned within 'block'
+	uint8_t dma;
+	uint8_t *rows;
+	int row_bytes;
+	uint16_t offsets[LOG_GROUP_MAX_CHANNELS];
+
+	// Owned by the sampler: rows staged in the half being filled,
+	// and the row of the block its batch goes to
+	int stage_half;
+	int stage_rows;
+	int dma_idx;
+	int dma_rows;
+	uint32_t dma_dropped;
+
+	// Advanced by the DMA done ISR with DMA capture
+	int buffer_idx;
+	int num_samples;
+	uint32_t dma_batches;
+
+	uint32_t seq;
+	int post_left;
+} log_group_t;
+
+static log_group_t group = {0};
+
+// Largest row: timestamp, seq and 64-bit values
+#define GROUP_ROW_MAX_BYTES		(2 * sizeof(uint32_t) + LOG_GROUP_MAX_CHANNELS * sizeof(uint64_t))
+
+#define CACHE_LINE_BYTES		(32)
+
+// Two halves: one being filled by the sampler, one being read by the DMA
+static uint8_t stage[2][LOG_DMA_BATCH_ROWS * GROUP_ROW_MAX_BYTES] __attribute__((aligned(CACHE_LINE_BYTES)));
+
+// Sample buffers are carved out of this region (see lscript.ld)
+// when variables are registered
+extern uint8_t _log_arena_start[];
+extern uint8_t _log_arena_end[];
+
+static uint8_t *arena_top = _log_arena_start;
+
+static uint8_t _dump_is_active(void);
+
+static uint8_t log_running;
+
+static task_control_block_t tcb;
+
+typedef struct log_trig_t {
+	log_trig_e mode; // 0 when logging is plain start / stop
+	int var_idx;
+	float level;
+	float level_hi;
+	int post_samples;
+
+	double prev;
+	uint8_t have_prev;
+	uint8_t fired;
+	uint32_t timestamp;
+} log_trig_t;
+
+static log_trig_t trig = {0};
+
+// Set by log_trigger(), possibly from an ISR
+static volatile uint8_t trig_request = 0;
+
+
+void log_init(void)
+{
+	// Register task which samples variables etc
+	// NOTE: this runs at the base scheduler time quantum,
+	//       or as fast as possible!
+	scheduler_tcb_init(&tcb, log_callback, NULL, "log", LOG_INTERVAL_USEC);
+	scheduler_tcb_register(&tcb);
+
+	// Initialize all the variables to NULL address,
+	// which indicates they aren't active
+	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
+		vars[i].addr = NULL;
+	}
+
+	// Start with logging disabled
+	log_stop();
+
+	// Register command
+	cmd_log_register();
+}
+
+int log_type_get_width(var_type_e type)
+{
+	switch (type) {
+	case INT8:
+	case UINT8:
+		return 1;
+	case INT16:
+	case UINT16:
+		return 2;
+	case INT:
+	case UINT32:
+	case FLOAT:
+		return 4;
+	case INT64:
+	case UINT64:
+	case DOUBLE:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+static const char *type_names[] = {
+		"", "int", "float", "double", "int8", "uint8",
+		"int16", "uint16", "uint32", "int64", "uint64"
+};
+
+var_type_e log_type_from_name(const char *name)
+{
+	if (strcmp("int32", name) == 0) {
+		return INT;
+	}
+
+	for (int t = INT; t <= UINT64; t++) {
+		if (strcmp(type_names[t], name) == 0) {
+			return (var_type_e) t;
+		}
+	}
+
+	return 0;
+}
+
+const char *log_type_get_name(var_type_e type)
+{
+	if (type < INT || type > UINT64) {
+		return "?";
+	}
+
+	return type_names[type];
+}
+
+// Values are unaligned within the group block
+// and stream rows, so always go through memcpy
+static double _as_double(var_type_e type, const void *value)
+{
+	union {
+		int8_t i8;
+		uint8_t u8;
+		int16_t i16;
+		uint16_t u16;
+		int32_t i32;
+		uint32_t u32;
+		int64_t i64;
+		uint64_t u64;
+		float f;
+		double d;
+	} u;
+
+	memcpy(&u, value, log_type_get_width(type));
+
+	switch (type) {
+	case INT8:		return u.i8;
+	case UINT8:		return u.u8;
+	case INT16:		return u.i16;
+	case UINT16:	return u.u16;
+	case INT:		return u.i32;
+	case UINT32:	return u.u32;
+	case INT64:		return (double) u.i64;
+	case UINT64:	return (double) u.u64;
+	case FLOAT:		return u.f;
+	case DOUBLE:	return u.d;
+	default:		return 0.0;
+	}
+}
+
+void log_value_print(var_type_e type, const void *value)
+{
+	switch (type) {
+	case INT8:
+	case INT16:
+	case INT:
+		debug_printf("%ld", (long) _as_double(type, value));
+		break;
+	case UINT8:
+	case UINT16:
+	case UINT32:
+		debug_printf("%lu", (unsigned long) _as_double(type, value));
+		break;
+	case INT64:
+	{
+		int64_t x;
+		memcpy(&x, value, sizeof(x));
+		debug_printf("%lld", (long long) x);
+		break;
+	}
+	case UINT64:
+	{
+		uint64_t x;
+		memcpy(&x, value, sizeof(x));
+		debug_printf("%llu", (unsigned long long) x);
+		break;
+	}
+	case FLOAT:
+		debug_printf("%f", _as_double(type, value));
+		break;
+	case DOUBLE:
+		// All the digits a double holds reliably; the
+		// binary dump is exact
+		debug_printf("%.15g", _as_double(type, value));
+		break;
+	default:
+		break;
+	}
+}
+
+static void _read_value(log_var_t *v, void *dst)
+{
+	memcpy(dst, v->addr, log_type_get_width(v->type));
+}
+
+// Decimated outputs are stored as float, or as double
+// when the variable is 64-bit so no precision is lost
+static var_type_e _stored_type(log_var_t *v)
+{
+	if (v->decim == LOG_DECIM_NONE) {
+		return v->type;
+	}
+
+	return (log_type_get_width(v->type) == 8) ? DOUBLE : FLOAT;
+}
+
+static void _store_double(var_type_e type, uint8_t *dst, double x)
+{
+	if (type == DOUBLE) {
+		memcpy(dst, &x, sizeof(x));
+	} else {
+		float f = (float) x;
+		memcpy(dst, &f, sizeof(f));
+	}
+}
+
+// Arrays in the arena start 8 byte aligned, whatever their width
+static uint64_t _array_bytes(int width, int depth)
+{
+	return ((uint64_t) width * depth + 7) & ~((uint64_t) 7);
+}
+
+static uint64_t _var_bytes(int depth, int width, log_decim_e decim)
+{
+	int num_arrays = (decim == LOG_DECIM_ENVELOPE) ? 3 : 1;
+	return _array_bytes(sizeof(uint32_t), depth) + num_arrays * _array_bytes(width, depth);
+}
+
+static void _var_layout(log_var_t *v, void *block)
+{
+	uint8_t *p = (uint8_t *) block;
+
+	v->timestamps = (uint32_t *) p;
+	p += _array_bytes(sizeof(uint32_t), v->depth);
+
+	v->values = p;
+	p += _array_bytes(v->width, v->depth);
+
+	if (v->decim == LOG_DECIM_ENVELOPE) {
+		v->mins = p;
+		p += _array_bytes(v->width, v->depth);
+		v->maxs = p;
+	} else {
+		v->mins = NULL;
+		v->maxs = NULL;
+	}
+}
+
+// Blocks are carved from the start of the arena block
+static pack_block_t *_pack_block(log_var_t *v, int i)
+{
+	return (pack_block_t *) ((uint8_t *) v->timestamps + i * PACK_BLOCK_BYTES);
+}
+
+static uint64_t _to_bits(var_type_e type, const void *value)
+{
+	uint64_t bits = 0;
+	memcpy(&bits, value, log_type_get_width(type));
+
+	// Sign-extend so small negative steps stay small
+	switch (type) {
+	case INT8:	return (uint64_t) (int64_t) (int8_t) bits;
+	case INT16:	return (uint64_t) (int64_t) (int16_t) bits;
+	case INT:	return (uint64_t) (int64_t) (int32_t) bits;
+	default:	return bits;
+	}
+}
+
+static uint64_t _zigzag(int64_t x)
+{
+	return ((uint64_t) x << 1) ^ (uint64_t) (x >> 63);
+}
+
+static int64_t _unzigzag(uint64_t x)
+{
+	return (int64_t) (x >> 1) ^ -(int64_t) (x & 1);
+}
+
+static int _put_varint(uint8_t *dst, uint64_t x)
+{
+	int n = 0;
+
+	while (x >= 0x80) {
+		dst[n++] = (uint8_t) x | 0x80;
+		x >>= 7;
+	}
+	dst[n++] = (uint8_t) x;
+
+	return n;
+}
+
+static uint64_t _get_varint(const uint8_t *src, int *offset)
+{
+	uint64_t x = 0;
+	int shift = 0;
+	uint8_t byte;
+
+	do {
+		byte = src[(*offset)++];
+		x |= (uint64_t) (byte & 0x7F) << shift;
+		shift += 7;
+	} while ((byte & 0x80) && shift < 64);
+
+	return x;
+}
+
+// At most PACK_MAX_SAMPLE_BYTES of encoding plus one block switch,
+// so the cost per sample is bounded whatever the signal does
+static void _pack_sample(log_var_t *v, uint32_t timestamp, const void *value)
+{
+	uint64_t bits = _to_bits(_stored_type(v), value);
+	pack_block_t *b = _pack_block(v, v->head_block);
+
+	if (b->num_samples > 0 && b->num_bytes + PACK_MAX_SAMPLE_BYTES > PACK_PAYLOAD_BYTES) {
+		// Head block is full, move on and reuse the oldest if needed
+		v->head_block = (v->head_block + 1) % v->num_blocks;
+
+		if (v->head_block == v->tail_block) {
+			v->num_samples -= _pack_block(v, v->tail_block)->num_samples;
+			v->tail_block = (v->tail_block + 1) % v->num_blocks;
+		}
+
+		b = _pack_block(v, v->head_block);
+		b->num_samples = 0;
+	}
+
+	if (b->num_samples == 0) {
+		b->bits = bits;
+		b->timestamp = timestamp;
+		b->num_bytes = 0;
+	} else {
+		uint8_t *p = (uint8_t *) (b + 1) + b->num_bytes;
+		int32_t jitter = (int32_t) (timestamp - v->last_timestamp - v->log_interval_usec);
+
+		int n = _put_varint(p, _zigzag(jitter));
+		n += _put_varint(p + n, _zigzag((int64_t) (bits - v->last_bits)));
+		b->num_bytes += n;
+	}
+
+	b->num_samples++;
+	v->num_samples++;
+	v->last_timestamp = timestamp;
+	v->last_bits = bits;
+}
+
+static void _unpack_start(log_var_t *v, pack_cursor_t *c)
+{
+	c->block = v->tail_block;
+	c->sample = 0;
+}
+
+// Decodes the next sample, oldest first
+static void _unpack_next(log_var_t *v, pack_cursor_t *c, uint32_t *timestamp, uint8_t *value)
+{
+	pack_block_t *b = _pack_block(v, c->block);
+
+	if (c->sample >= b->num_samples) {
+		c->block = (c->block + 1) % v->num_blocks;
+		c->sample = 0;
+		b = _pack_block(v, c->block);
+	}
+
+	if (c->sample == 0) {
+		c->bits = b->bits;
+		c->timestamp = b->timestamp;
+		c->offset = 0;
+	} else {
+		const uint8_t *p = (const uint8_t *) (b + 1);
+		c->timestamp += v->log_interval_usec + (int32_t) _unzigzag(_get_varint(p, &c->offset));
+		c->bits += (uint64_t) _unzigzag(_get_varint(p, &c->offset));
+	}
+
+	c->sample++;
+
+	*timestamp = c->timestamp;
+	memcpy(value, &c->bits, v->width);
+}
+
+static void _stats_clear(log_stats_t *st)
+{
+	st->count = 0;
+	st->sum = 0.0;
+	st->sumsq = 0.0;
+	st->below = 0;
+	st->above = 0;
+	memset(st->bins, 0, sizeof(st->bins));
+}
+
+static void _stats_input(log_var_t *v)
+{
+	log_stats_t *st = &v->stats;
+
+	uint64_t raw;
+	_read_value(v, &raw);
+	double x = _as_double(v->type, &raw);
+
+	if (st->count == 0) {
+		st->min = x;
+		st->max = x;
+	} else {
+		st->min = MIN(st->min, x);
+		st->max = MAX(st->max, x);
+	}
+
+	st->count++;
+	st->sum += x;
+	st->sumsq += x * x;
+
+	if (st->num_bins == 0) {
+		return;
+	}
+
+	if (x < st->lo) {
+		st->below++;
+	} else if (x >= st->hi) {
+		st->above++;
+	} else {
+		// Rounding can land exactly on hi
+		int bin = (int) ((x - st->lo) * st->num_bins / (st->hi - st->lo));
+		st->bins[MIN(bin, st->num_bins - 1)]++;
+	}
+}
+
+static void _decim_input(log_var_t *v)
+{
+	uint64_t raw;
+	_read_value(v, &raw);
+	double x = _as_double(v->type, &raw);
+
+	int j = v->decim_count++;
+
+	if (j == 0) {
+		v->min = x;
+		v->max = x;
+	} else {
+		v->min = MIN(v->min, x);
+		v->max = MAX(v->max, x);
+	}
+
+	if (v->decim == LOG_DECIM_CIC) {
+		// Second order CIC: a triangular window over the last two
+		// blocks, rising 1..R over the previous one and falling
+		// R-1..0 over this one. Each input is split between this
+		// output and the next, so outputs are centred on the start
+		// of their block: half a block late compared to 'mean'
+		int w = MIN(j + 1, v->decim_ratio);
+		v->acc += (v->decim_ratio - w) * x;
+		v->acc_next += w * x;
+	} else {
+		v->acc += x;
+	}
+}
+
+static void _decim_output(log_var_t *v, uint8_t *dst, int idx)
+{
+	var_type_e type = _stored_type(v);
+	double out;
+
+	if (v->decim == LOG_DECIM_CIC) {
+		out = v->acc / ((double) v->decim_ratio * v->decim_ratio);
+		v->acc = v->acc_next;
+		v->acc_next = 0.0;
+	} else {
+		out = v->acc / v->decim_count;
+		v->acc = 0.0;
+	}
+
+	_store_double(type, dst, out);
+
+	if (v->decim == LOG_DECIM_ENVELOPE) {
+		_store_double(type, &v->mins[idx * v->width], v->min);
+		_store_double(type, &v->maxs[idx * v->width], v->max);
+	}
+
+	v->decim_count = 0;
+}
+
+// Checks the newest sample of the trigger variable
+static uint8_t _trig_check(double x)
+{
+	uint8_t hit = 0;
+
+	switch (trig.mode) {
+	case LOG_TRIG_RISING:
+		hit = trig.have_prev && trig.prev < trig.level && x >= trig.level;
+		break;
+
+	case LOG_TRIG_FALLING:
+		hit = trig.have_prev && trig.prev > trig.level && x <= trig.level;
+		break;
+
+	case LOG_TRIG_WINDOW:
+		hit = x < trig.level || x > trig.level_hi;
+		break;
+
+	default:
+		break;
+	}
+
+	trig.prev = x;
+	trig.have_prev = 1;
+
+	return hit;
+}
+
+static void _trig_fire(uint32_t timestamp)
+{
+	trig.fired = 1;
+	trig.timestamp = timestamp;
+
+	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
+		vars[i].post_left = trig.post_samples;
+	}
+}
+
+// Commits the batch which just landed in the block
+static void _group_dma_done(void *arg)
+{
+	log_group_t *g = &group;
+
+	g->buffer_idx = (g->buffer_idx + g->dma_rows) % g->depth;
+	g->num_samples = MIN(g->num_samples + g->dma_rows, g->depth);
+	g->dma_batches++;
+}
+
+// Hands the rows staged so far to the DMA and moves on to
+// the other half. Called by the sampler, and once more by
+// log_stop() after the sampler has stopped for good
+static void _group_dma_kick(void)
+{
+	log_group_t *g = &group;
+	int n = g->stage_rows;
+
+	if (n == 0) {
+		return;
+	}
+
+	g->stage_rows = 0;
+
+	// The last batch must have landed before its half is reused,
+	// so rather than wait, give up this one
+	if (dma_is_busy(DMA_CHANNEL_LOG)) {
+		g->dma_dropped += n;
+		return;
+	}
+
+	uint8_t *src = stage[g->stage_half];
+	uint8_t *dst = &g->rows[g->dma_idx * g->row_bytes];
+
+	// The done ISR may run before dma_copy() returns
+	g->dma_rows = n;
+	g->dma_idx = (g->dma_idx + n) % g->depth;
+	g->stage_half ^= 1;
+
+	if (dma_copy(DMA_CHANNEL_LOG, dst, src, n * g->row_bytes, _group_dma_done, NULL) != SUCCESS) {
+		g->dma_idx = (g->dma_idx - n + g->depth) % g->depth;
+		g->stage_half ^= 1;
+		g->dma_dropped += n;
+	}
+}
+
+// Commits one row of the group. Called from either log_callback()
+// or log_sample_now(), never both, so this is the only writer.
+// With DMA capture the row only goes to the staging buffer, so
+// nothing in the arena is touched here
+static void _group_sample(uint32_t timestamp)
+{
+	log_group_t *g = &group;
+
+	// Start counting post-trigger rows once the trigger has fired
+	if (trig.fired && g->post_left < 0) {
+		g->post_left = trig.post_samples;
+	}
+
+	if (g->post_left == 0) {
+		return;
+	}
+
+	int i = g->buffer_idx;
+	int d = g->depth;
+	uint32_t *row = NULL;
+
+	if (g->dma) {
+		row = (uint32_t *) &stage[g->stage_half][g->stage_rows * g->row_bytes];
+		row[0] = timestamp;
+		row[1] = g->seq++;
+
+		// Values are packed, so zero the padding at the end of the row
+		row[g->row_bytes / sizeof(uint32_t) - 1] = 0;
+	} else {
+		g->block[i] = timestamp;
+		g->seqs[i] = g->seq++;
+	}
+
+	for (int c = 0; c < g->num_channels; c++) {
+		log_var_t *v = &vars[g->channels[c]];
+		uint8_t *dst = g->dma ? (uint8_t *) row + g->offsets[c] : &g->values[c][i * g->widths[c]];
+
+		memcpy(dst, v->addr, g->widths[c]);
+
+		if (trig.mode && !trig.fired && g->channels[c] == trig.var_idx) {
+			// Fired by log_callback(), which owns the trigger
+			if (_trig_check(_as_double(v->type, dst))) {
+				trig_request = 1;
+			}
+		}
+	}
+
+	if (g->post_left > 0) {
+		g->post_left--;
+	}
+
+	if (g->dma) {
+		g->stage_rows++;
+
+		// Batches never wrap around the end of the block, and
+		// the rows up to a freeze go out straight away
+		if (g->stage_rows == LOG_DMA_BATCH_ROWS || g->dma_idx + g->stage_rows == d || g->post_left == 0) {
+			_group_dma_kick();
+		}
+		return;
+	}
+
+	g->buffer_idx++;
+	if (g->buffer_idx >= d) {
+		g->buffer_idx = 0;
+	}
+
+	if (g->num_samples < d) {
+		g->num_samples++;
+	}
+}
+
+void log_callback(void *arg)
+{
+	// Streaming runs on its own, with or without a capture
+	log_stream_tick();
+
+	if (log_running == 0) {
+		return;
+	}
+
+	// Decide when to sample on the SysTick time base, so sampling
+	// stays aligned to time slices, but timestamp each sample with
+	// the precise global timer
+	uint64_t elapsed_usec = scheduler_get_elapsed_usec();
+	uint32_t timestamp = (uint32_t) cpu_timer_get_usec();
+
+	uint8_t fire = 0;
+	uint8_t all_frozen = 1;
+
+	for (uint8_t i = 0; i < LOG_MAX_NUM_VARS; i++) {
+		log_var_t *v = &vars[i];
+
+		if (v->addr == NULL || v->in_group) {
+			// Variable not active for logging, so skip
+			continue;
+		}
+
+		if (v->stats_only) {
+			// Nothing stored, so nothing to hold around a trigger
+			_stats_input(v);
+			continue;
+		}
+
+		if (v->post_left == 0) {
+			// Holding the capture around the trigger
+			continue;
+		}
+
+		all_frozen = 0;
+
+		if (v->decim != LOG_DECIM_NONE) {
+			_decim_input(v);
+		}
+
+		uint64_t usec_since_last_run = elapsed_usec - v->last_logged_usec;
+
+		if (usec_since_last_run >= v->log_interval_usec) {
+			// Time to log this variable!
+			v->last_logged_usec = elapsed_usec;
+
+			// Compressed samples are built up here first
+			uint64_t unpacked;
+			int k = v->buffer_idx;
+			uint8_t *value = v->packed ? (uint8_t *) &unpacked : &v->values[k * v->width];
+
+			if (v->decim != LOG_DECIM_NONE) {
+				_decim_output(v, value, k);
+			} else {
+				_read_value(v, value);
+			}
+
+			if (v->packed) {
+				_pack_sample(v, timestamp, value);
+			} else {
+				v->timestamps[k] = timestamp;
+
+				v->buffer_idx++;
+				if (v->buffer_idx >= v->depth) {
+					v->buffer_idx = 0;
+				}
+
+				if (v->num_samples < v->depth) {
+					v->num_samples++;
+				}
+			}
+
+			if (v->post_left > 0) {
+				v->post_left--;
+			}
+
+			if (trig.mode && !trig.fired && i == trig.var_idx) {
+				fire |= _trig_check(_as_double(_stored_type(v), value));
+			}
+		}
+	}
+
+	if (group.num_channels > 0) {
+		if (group.post_left != 0) {
+			all_frozen = 0;
+		}
+
+		// All channels share one timestamp and sequence number
+		uint64_t usec_since_last_run = elapsed_usec - group.last_logged_usec;
+
+		if (group.log_interval_usec != 0 && usec_since_last_run >= group.log_interval_usec) {
+			group.last_logged_usec = elapsed_usec;
+			_group_sample(timestamp);
+		}
+	}
+
+	if (trig.mode && !trig.fired) {
+		// Samples taken in this slice count as before the trigger
+		if (fire || trig_request) {
+			_trig_fire(timestamp);
+		}
+	} else if (trig.fired && all_frozen) {
+		// Every buffer now holds its samples around the trigger
+		log_running = 0;
+	}
+}
+
+void log_start(void)
+{
+	// (Re-)arm the trigger; with no trigger set,
+	// buffers are never frozen
+	trig.have_prev = 0;
+	trig.fired = 0;
+	trig_request = 0;
+
+	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
+		vars[i].post_left = -1;
+	}
+	group.post_left = -1;
+
+	log_running = 1;
+}
+
+void log_sample_now(void)
+{
+	log_stream_sample_now();
+
+	// Only when the group is sampled on demand
+	if (!log_running || group.num_channels == 0 || group.log_interval_usec != 0) {
+		return;
+	}
+
+	_group_sample((uint32_t) cpu_timer_get_usec());
+}
+
+void log_stop(void)
+{
+	// Stored before the flush below, so an RT task calling
+	// log_sample_now() from here on finds logging stopped and
+	// leaves the staging buffer alone; a sampler which started
+	// earlier has already finished, as it preempted this one
+	__atomic_store_n(&log_running, 0, __ATOMIC_SEQ_CST);
+
+	// Staged rows would otherwise wait for the next batch. The
+	// last batch lands in microseconds
+	if (group.dma && group.num_channels > 0) {
+		while (dma_is_busy(DMA_CHANNEL_LOG)) {
+		}
+
+		_group_dma_kick();
+	}
+}
+
+uint8_t log_is_logging(void)
+{
+	return log_running;
+}
+
+int log_trig_set(log_trig_e mode, int idx, float level, float level_hi, int post_samples)
+{
+	// Can't change the trigger while armed
+	if (log_running) {
+		return FAILURE;
+	}
+
+	if (post_samples < 0) {
+		return FAILURE;
+	}
+
+	if (mode != LOG_TRIG_SOFTWARE) {
+		if (idx < 0 || idx >= LOG_MAX_NUM_VARS || vars[idx].addr == NULL || vars[idx].stats_only) {
+			return FAILURE;
+		}
+
+		if (mode == LOG_TRIG_WINDOW && level_hi < level) {
+			return FAILURE;
+		}
+	}
+
+	trig.mode = mode;
+	trig.var_idx = idx;
+	trig.level = level;
+	trig.level_hi = level_hi;
+	trig.post_samples = post_samples;
+	trig.fired = 0;
+
+	return SUCCESS;
+}
+
+void log_trig_off(void)
+{
+	trig.mode = 0;
+	trig.fired = 0;
+}
+
+int log_trigger(void)
+{
+	if (!log_running || trig.mode == 0) {
+		return FAILURE;
+	}
+
+	trig_request = 1;
+	return SUCCESS;
+}
+
+// Gives '*block' at least 'bytes' of the arena
+static int _arena_alloc(void **block, uint32_t *capacity, uint64_t bytes)
+{
+	// Shrinking, or re-registering with the same size, keeps the block
+	if (*block != NULL && bytes <= *capacity) {
+		return SUCCESS;
+	}
+
+	// The most recently allocated block can grow in place,
+	// otherwise its space is lost until 'log reset'
+	uint8_t *start = arena_top;
+	if (*block != NULL && (uint8_t *) *block + *capacity == arena_top) {
+		start = (uint8_t *) *block;
+	}
+
+	// Keep every block 8 byte aligned
+	bytes = (bytes + 7) & ~((uint64_t) 7);
+
+	if (bytes > (uint64_t) (_log_arena_end - start)) {
+		return FAILURE;
+	}
+
+	*block = start;
+	*capacity = (uint32_t) bytes;
+	arena_top = start + bytes;
+
+	return SUCCESS;
+}
+
+int log_var_register(int idx, char* name, void *addr, uint32_t samples_per_sec, int depth, var_type_e type)
+{
+	// Sanity check variable idx
+	if (idx < 0 || idx >= LOG_MAX_NUM_VARS) { HANG; }
+
+	log_var_t *v = &vars[idx];
+
+	// Can't move a buffer the group is writing, or change the
+	// width of a value the stream packs into its rows
+	if (v->in_group || log_stream_has_var(idx)) {
+		return FAILURE;
+	}
+
+	// A dump may be reading the buffer
+	if (_dump_is_active()) {
+		return FAILURE;
+	}
+
+	int width = log_type_get_width(type);
+	if (width == 0 || depth <= 0) {
+		return FAILURE;
+	}
+
+	void *block = v->timestamps;
+	if (_arena_alloc(&block, &v->capacity, _var_bytes(depth, width, LOG_DECIM_NONE)) != SUCCESS) {
+		return FAILURE;
+	}
+
+	// Populate variable entry...
+	strncpy(v->name, name, LOG_VAR_NAME_MAX_CHARS);
+	v->addr = addr;
+	v->type = type;
+	v->depth = depth;
+	v->width = width;
+	v->decim = LOG_DECIM_NONE;
+	v->packed = 0;
+	v->stats_only = 0;
+	_var_layout(v, block);
+
+	// Calculate 'log_interval_usec' from samples per second
+	v->log_interval_usec = USEC_IN_SEC / samples_per_sec;
+	v->decim_ratio = MAX(v->log_interval_usec / LOG_INTERVAL_USEC, 1);
+
+	log_var_empty(idx);
+
+	return SUCCESS;
+}
+
+int log_var_set_decim(int idx, log_decim_e decim)
+{
+	log_var_t *v = &vars[idx];
+
+	if (log_running || _dump_is_active() || v->addr == NULL || v->in_group) {
+		return FAILURE;
+	}
+
+	// Compressed buffers hold one value per sample
+	if (v->packed && decim == LOG_DECIM_ENVELOPE) {
+		return FAILURE;
+	}
+
+	// Outputs may change width, and envelopes keep min and max too
+	log_decim_e old_decim = v->decim;
+	v->decim = decim;
+	int width = log_type_get_width(_stored_type(v));
+
+	void *block = v->timestamps;
+	if (_arena_alloc(&block, &v->capacity, _var_bytes(v->depth, width, decim)) != SUCCESS) {
+		v->decim = old_decim;
+		return FAILURE;
+	}
+
+	v->width = width;
+	_var_layout(v, block);
+	v->num_blocks = v->capacity / PACK_BLOCK_BYTES;
+
+	log_var_empty(idx);
+
+	return SUCCESS;
+}
+
+int log_var_set_compress(int idx, uint8_t enable)
+{
+	log_var_t *v = &vars[idx];
+
+	if (log_running || _dump_is_active() || v->addr == NULL || v->in_group) {
+		return FAILURE;
+	}
+
+	// Compressed buffers hold one value per sample, and need a block
+	// to write while the oldest one is being given up
+	if (enable && (v->decim == LOG_DECIM_ENVELOPE || v->capacity / PACK_BLOCK_BYTES < 2)) {
+		return FAILURE;
+	}
+
+	// Same arena block, so more samples fit in the same space
+	v->packed = enable;
+	v->num_blocks = v->capacity / PACK_BLOCK_BYTES;
+
+	log_var_empty(idx);
+
+	return SUCCESS;
+}
+
+int log_var_read(int idx, void *value)
+{
+	log_var_t *v = &vars[idx];
+
+	if (v->addr == NULL) {
+		return FAILURE;
+	}
+
+	_read_value(v, value);
+	return SUCCESS;
+}
+
+var_type_e log_var_get_type(int idx)
+{
+	return vars[idx].type;
+}
+
+const char *log_var_get_name(int idx)
+{
+	return vars[idx].name;
+}
+
+int log_var_set_stats(int idx, uint8_t enable, double lo, double hi, int num_bins)
+{
+	log_var_t *v = &vars[idx];
+
+	if (log_running || _dump_is_active() || v->addr == NULL || v->in_group) {
+		return FAILURE;
+	}
+
+	if (num_bins < 0 || num_bins > LOG_STATS_MAX_BINS || (num_bins > 0 && !(hi > lo))) {
+		return FAILURE;
+	}
+
+	// The trigger needs samples of its variable
+	if (enable && trig.mode && trig.mode != LOG_TRIG_SOFTWARE && trig.var_idx == idx) {
+		return FAILURE;
+	}
+
+	v->stats_only = enable;
+	v->stats.num_bins = num_bins;
+	v->stats.lo = lo;
+	v->stats.hi = hi;
+
+	log_var_empty(idx);
+
+	return SUCCESS;
+}
+
+void log_var_empty(int idx)
+{
+	// Samples are only read up to 'num_samples',
+	// so the buffer itself doesn't need clearing
+	vars[idx].buffer_idx = 0;
+	vars[idx].last_logged_usec = 0;
+	vars[idx].num_samples = 0;
+	vars[idx].post_left = -1;
+	vars[idx].decim_count = 0;
+	vars[idx].acc = 0.0;
+	vars[idx].acc_next = 0.0;
+
+	_stats_clear(&vars[idx].stats);
+
+	vars[idx].head_block = 0;
+	vars[idx].tail_block = 0;
+	if (vars[idx].packed) {
+		_pack_block(&vars[idx], 0)->num_samples = 0;
+	}
+}
+
+// Lays out the group in the arena for the current capture mode
+static int _group_set(uint32_t log_interval_usec, int depth, int *idxs, int num_channels)
+{
+	// The DMA may still be writing the block
+	if (log_running || _dump_is_active() || dma_is_busy(DMA_CHANNEL_LOG)) {
+		return FAILURE;
+	}
+
+	if (depth <= 0 || num_channels <= 0 || num_channels > LOG_GROUP_MAX_CHANNELS) {
+		return FAILURE;
+	}
+
+	for (int c = 0; c < num_channels; c++) {
+		if (idxs[c] < 0 || idxs[c] >= LOG_MAX_NUM_VARS || vars[idxs[c]].addr == NULL) {
+			return FAILURE;
+		}
+
+		// The group stores raw samples, so it would silently
+		// drop a variable's filter, compression or statistics
+		log_var_t *v = &vars[idxs[c]];
+		if (v->stats_only || v->packed || v->decim != LOG_DECIM_NONE) {
+			return FAILURE;
+		}
+	}
+
+	int row_bytes = 2 * sizeof(uint32_t);
+	for (int c = 0; c < num_channels; c++) {
+		row_bytes += log_type_get_width(vars[idxs[c]].type);
+	}
+	row_bytes = (row_bytes + 3) & ~3;
+
+	void *block = group.block;
+	uint64_t bytes;
+
+	if (group.dma) {
+		// Room to align the rows, which share no cache line with
+		// the CPU's buffers around them
+		uint64_t rows_bytes = (uint64_t) depth * row_bytes;
+		bytes = ((rows_bytes + CACHE_LINE_BYTES - 1) & ~(CACHE_LINE_BYTES - 1)) + CACHE_LINE_BYTES;
+	} else {
+		bytes = 2 * _array_bytes(sizeof(uint32_t), depth);
+		for (int c = 0; c < num_channels; c++) {
+			bytes += _array_bytes(log_type_get_width(vars[idxs[c]].type), depth);
+		}
+	}
+
+	if (_arena_alloc(&block, &group.capacity, bytes) != SUCCESS) {
+		return FAILURE;
+	}
+
+	log_group_off();
+
+	group.block = (uint32_t *) block;
+	group.depth = depth;
+	group.num_channels = num_channels;
+	group.row_bytes = row_bytes;
+	group.rows = (uint8_t *) (((uintptr_t) block + CACHE_LINE_BYTES - 1) & ~(uintptr_t) (CACHE_LINE_BYTES - 1));
+
+	uint8_t *p = (uint8_t *) block + _array_bytes(sizeof(uint32_t), depth);
+	group.seqs = (uint32_t *) p;
+	p += _array_bytes(sizeof(uint32_t), depth);
+
+	int offset = 2 * sizeof(uint32_t);
+
+	for (int c = 0; c < num_channels; c++) {
+		group.channels[c] = idxs[c];
+		group.widths[c] = log_type_get_width(vars[idxs[c]].type);
+		group.offsets[c] = offset;
+		offset += group.widths[c];
+
+		if (!group.dma) {
+			group.values[c] = p;
+			p += _array_bytes(group.widths[c], depth);
+		}
+
+		vars[idxs[c]].in_group = 1;
+	}
+
+	group.log_interval_usec = log_interval_usec;
+	group.last_logged_usec = 0;
+	group.buffer_idx = 0;
+	group.num_samples = 0;
+	group.seq = 0;
+	group.post_left = -1;
+
+	group.stage_half = 0;
+	group.stage_rows = 0;
+	group.dma_idx = 0;
+	group.dma_rows = 0;
+	group.dma_batches = 0;
+	group.dma_dropped = 0;
+
+	return SUCCESS;
+}
+
+int log_group_set(uint32_t samples_per_sec, int depth, int *idxs, int num_channels)
+{
+	uint32_t log_interval_usec = (samples_per_sec > 0) ? (USEC_IN_SEC / samples_per_sec) : 0;
+
+	return _group_set(log_interval_usec, depth, idxs, num_channels);
+}
+
+int log_group_set_dma(uint8_t enable)
+{
+	if (group.num_channels == 0) {
+		return FAILURE;
+	}
+
+	int idxs[LOG_GROUP_MAX_CHANNELS];
+	for (int c = 0; c < group.num_channels; c++) {
+		idxs[c] = group.channels[c];
+	}
+
+	// Same group, laid out again for the new mode
+	uint8_t was = group.dma;
+	group.dma = enable ? 1 : 0;
+
+	if (_group_set(group.log_interval_usec, group.depth, idxs, group.num_channels) != SUCCESS) {
+		group.dma = was;
+		return FAILURE;
+	}
 
-	int num_samples;
-	buffer_entry_t buffer[LOG_BUFFER_LENGTH];
-	int buffer_idx;
-} log_var_t;
+	return SUCCESS;
+}
 
-static log_var_t vars[LOG_MAX_NUM_VARS] = {0};
+int log_group_off(void)
+{
+	if (log_running) {
+		return FAILURE;
+	}
 
-static uint8_t log_running;
+	for (int c = 0; c < group.num_channels; c++) {
+		vars[group.channels[c]].in_group = 0;
+	}
 
-static task_control_block_t tcb;
+	// Keep the block to reuse for the next group
+	group.num_channels = 0;
 
+	return SUCCESS;
+}
 
-void log_init(void)
+int log_reset(void)
 {
-	// Register task which samples variables etc
-	// NOTE: this runs at the base scheduler time quantum,
-	//       or as fast as possible!
-	scheduler_tcb_init(&tcb, log_callback, NULL, "log", LOG_INTERVAL_USEC);
-	scheduler_tcb_register(&tcb);
+	// Buffers are in use
+	if (log_running || _dump_is_active() || log_stream_is_running() || dma_is_busy(DMA_CHANNEL_LOG)) {
+		return FAILURE;
+	}
 
-	// Initialize all the variables to NULL address,
-	// which indicates they aren't active
 	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
 		vars[i].addr = NULL;
+		vars[i].timestamps = NULL;
+		vars[i].depth = 0;
+		vars[i].capacity = 0;
+		vars[i].in_group = 0;
+		log_var_empty(i);
 	}
 
-	// Start with logging disabled
-	log_stop();
+	group.num_channels = 0;
+	group.block = NULL;
+	group.capacity = 0;
+	group.dma = 0;
 
-	// Register command
-	cmd_log_register();
+	arena_top = _log_arena_start;
+	log_trig_off();
+
+	return SUCCESS;
 }
 
-void log_callback(void *arg)
+int log_stats_print(int idx)
 {
-	if (log_running == 0) {
-		return;
+	if (idx >= 0 && (vars[idx].addr == NULL || !vars[idx].stats_only)) {
+		return FAILURE;
 	}
 
-	for (uint8_t i = 0; i < LOG_MAX_NUM_VARS; i++) {
+	debug_printf("   %-16s %10s %12s %12s %12s %12s %12s\r\n", "name", "count", "mean", "rms", "std", "min", "max");
+
+	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
 		log_var_t *v = &vars[i];
+		log_stats_t *st = &v->stats;
 
-		if (v->addr == NULL) {
-			// Variable not active for logging, so skip
+		if (v->addr == NULL || !v->stats_only || (idx >= 0 && i != idx)) {
 			continue;
 		}
 
-		uint64_t elapsed_usec = scheduler_get_elapsed_usec();
-		uint64_t usec_since_last_run = elapsed_usec - v->last_logged_usec;
+		if (st->count == 0) {
+			debug_printf("%2d %-16s %10d\r\n", i, v->name, 0);
+			continue;
+		}
 
-		if (usec_since_last_run >= v->log_interval_usec) {
-			// Time to log this variable!
-			v->last_logged_usec = elapsed_usec;
+		double mean = st->sum / st->count;
+		double ms = st->sumsq / st->count;
 
-			v->buffer[v->buffer_idx].timestamp = (uint32_t) elapsed_usec;
-
-			if (v->type == INT) {
-				v->buffer[v->buffer_idx].value = *((uint32_t *)v->addr);
-			} else if (v->type == FLOAT) {
-				float *f = (float *) &(v->buffer[v->buffer_idx].value);
-				*f = *((float *)v->addr);
-			} else if (v->type == DOUBLE) {
-				float *f = (float *) &(v->buffer[v->buffer_idx].value);
-				double value = *((double *)v->addr);
-				*f = (float) value;
-			}
+		// Rounding can make the variance slightly negative
+		double var = MAX(ms - mean * mean, 0.0);
 
-			v->buffer_idx++;
-			if (v->buffer_idx >= LOG_BUFFER_LENGTH) {
-				v->buffer_idx = 0;
-			}
+		debug_printf("%2d %-16s %10llu %12g %12g %12g %12g %12g\r\n", i, v->name, (unsigned long long) st->count,
+				mean, sqrt(ms), sqrt(var), st->min, st->max);
+	}
 
-			if (v->num_samples < LOG_VARIABLE_SAMPLE_DEPTH) {
-				v->num_samples++;
-			}
-		}
+	if (idx < 0 || vars[idx].stats.num_bins == 0) {
+		return SUCCESS;
 	}
-}
 
-void log_start(void)
-{
-	log_running = 1;
-}
+	log_stats_t *st = &vars[idx].stats;
+	double step = (st->hi - st->lo) / st->num_bins;
 
-void log_stop(void)
-{
-	log_running = 0;
+	debug_printf("Histogram:\r\n");
+	debug_printf("  %12s .. %-12g %10lu\r\n", "", st->lo, st->below);
+	for (int b = 0; b < st->num_bins; b++) {
+		debug_printf("  %12g .. %-12g %10lu\r\n", st->lo + b * step, st->lo + (b + 1) * step, st->bins[b]);
+	}
+	debug_printf("  %12g .. %-12s %10lu\r\n", st->hi, "", st->above);
+
+	return SUCCESS;
 }
 
-uint8_t log_is_logging(void)
+uint32_t log_get_arena_free(void)
 {
-	return log_running;
+	return (uint32_t) (_log_arena_end - arena_top);
 }
 
-void log_var_register(int idx, char* name, void *addr, uint32_t samples_per_sec, var_type_e type)
+void log_info_print(void)
 {
-	// Sanity check variable idx
-	if (idx < 0 || idx >= LOG_MAX_NUM_VARS) { HANG; }
+	static const char *decim_names[] = {"", "", "  mean", "  cic", "  envelope"};
 
-	// Populate variable entry...
-	strncpy(vars[idx].name, name, LOG_VAR_NAME_MAX_CHARS);
-	vars[idx].addr = addr;
-	vars[idx].type = type;
+	for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
+		log_var_t *v = &vars[i];
 
-	// Calculate 'log_interval_usec' from samples per second
-	vars[idx].log_interval_usec = USEC_IN_SEC / samples_per_sec;
-	vars[idx].last_logged_usec = 0;
-}
+		if (v->addr == NULL) {
+			continue;
+		}
 
-void log_var_empty(int idx)
-{
-	vars[idx].buffer_idx = 0;
-	vars[idx].last_logged_usec = 0;
-	vars[idx].num_samples = 0;
-	memset(vars[idx].buffer, 0, LOG_BUFFER_LENGTH);
+		if (v->in_group) {
+			debug_printf("%2d %-16s %-7s in group\r\n", i, v->name, log_type_get_name(v->type));
+		} else if (v->stats_only) {
+			debug_printf("%2d %-16s %-7s stats of %llu samples\r\n", i, v->name, log_type_get_name(v->type),
+					(unsigned long long) v->stats.count);
+		} else {
+			debug_printf("%2d %-16s %-7s %7lu Hz  ", i, v->name, log_type_get_name(v->type),
+					USEC_IN_SEC / v->log_interval_usec);
+
+			if (v->packed) {
+				// Compared to the same samples stored uncompressed
+				uint32_t used = ((v->head_block - v->tail_block + v->num_blocks) % v->num_blocks + 1) * PACK_BLOCK_BYTES;
+				uint32_t ratio10 = (uint32_t) (10ULL * v->num_samples * (sizeof(uint32_t) + v->width) / used);
+				debug_printf("%d samples in %lu / %lu KB, %lu.%lux", v->num_samples, used / 1024,
+						v->capacity / 1024, ratio10 / 10, ratio10 % 10);
+			} else {
+				debug_printf("%d / %d samples", v->num_samples, v->depth);
+			}
+
+			debug_printf("%s\r\n", decim_names[v->decim]);
+		}
+	}
+
+	if (group.num_channels > 0) {
+		if (group.log_interval_usec != 0) {
+			debug_printf("Group: %d channels at %lu Hz", group.num_channels, USEC_IN_SEC / group.log_interval_usec);
+		} else {
+			debug_printf("Group: %d channels on log_sample_now()", group.num_channels);
+		}
+		debug_printf("  %d / %d samples\r\n", group.num_samples, group.depth);
+
+		if (group.dma) {
+			debug_printf("Group DMA: %lu batches, %lu rows dropped\r\n", group.dma_batches, group.dma_dropped);
+		}
+	}
+
+	debug_printf("Arena: %lu / %lu KB free\r\n", log_get_arena_free() / 1024,
+			(uint32_t) (_log_arena_end - _log_arena_start) / 1024);
+
+	if (trig.mode == 0) {
+		return;
+	}
+
+	static const char *mode_names[] = {"", "rising", "falling", "window", "sw"};
+
+	debug_printf("Trigger: %s", mode_names[trig.mode]);
+	if (trig.mode != LOG_TRIG_SOFTWARE) {
+		debug_printf(" on '%s' at %f", vars[trig.var_idx].name, trig.level);
+		if (trig.mode == LOG_TRIG_WINDOW) {
+			debug_printf(" .. %f", trig.level_hi);
+		}
+	}
+	debug_printf(", %d post samples\r\n", trig.post_samples);
+
+	if (trig.fired) {
+		debug_printf("Fired at %lu usec%s\r\n", trig.timestamp, log_running ? "" : ", capture done");
+	} else if (log_running) {
+		debug_printf("Armed\r\n");
+	}
 }
 
 
@@ -151,30 +1506,31 @@ typedef enum sm_states_e {
 	TITLE = 1,
 	NUM_SAMPLES,
 	HEADER,
-	VARIABLES_TS,
-	VARIABLES_VALUE,
-	FOOTER,
-	REMOVE_TASK
+	VARIABLES,
+	FOOTER
 } sm_states_e;
 
 typedef struct sm_ctx_t {
 	sm_states_e state;
 	int var_idx;
+	int first;
 	int sample_idx;
-	task_control_block_t tcb;
+	pack_cursor_t cursor;
+	job_t job;
 } sm_ctx_t;
 
 #define MSG_LENGTH		(128)
 
-#define SM_UPDATES_PER_SEC		(200)
-#define SM_INTERVAL_USEC		(USEC_IN_SEC / SM_UPDATES_PER_SEC)
-
-void state_machine_callback(void *arg)
+static job_status_e _dump_step(void *arg)
 {
 	sm_ctx_t *ctx = (sm_ctx_t *) arg;
 
+	// Wait for UART to drain so no output is lost
+	if (serial_get_free_space() < MSG_LENGTH) {
+		return JOB_YIELD;
+	}
+
 	log_var_t *v = &vars[ctx->var_idx];
-	buffer_entry_t *e = &v->buffer[ctx->sample_idx];
 
 	switch (ctx->state) {
 	case TITLE:
@@ -189,61 +1545,426 @@ void state_machine_callback(void *arg)
 
 	case HEADER:
 		debug_printf("-------START-------\r\n");
-		ctx->state = VARIABLES_TS;
+		ctx->state = (v->num_samples > 0) ? VARIABLES : FOOTER;
 		break;
 
-	case VARIABLES_TS:
-		// Print just the timestamp
-		debug_printf("> %ld\t\t", e->timestamp);
+	case VARIABLES:
+	{
+		uint32_t timestamp;
+		uint64_t unpacked;
+		int k = (ctx->first + ctx->sample_idx) % v->depth;
 
-		ctx->state = VARIABLES_VALUE;
-		break;
+		if (v->packed) {
+			_unpack_next(v, &ctx->cursor, &timestamp, (uint8_t *) &unpacked);
+		} else {
+			timestamp = v->timestamps[k];
+			memcpy(&unpacked, &v->values[k * v->width], v->width);
+		}
 
-	case VARIABLES_VALUE:
-		// Print just the value
-		if (v->type == INT) {
-			debug_printf("%ld\r\n", e->value);
-		} else if (v->type == FLOAT || v->type == DOUBLE) {
-			float *f = (float *) &(e->value);
-			debug_printf("%f\r\n", *f);
+		// Print the timestamp and value
+		debug_printf("> %ld\t\t", timestamp);
+		log_value_print(_stored_type(v), &unpacked);
+
+		if (v->decim == LOG_DECIM_ENVELOPE) {
+			debug_printf("\t");
+			log_value_print(_stored_type(v), &v->mins[k * v->width]);
+			debug_printf("\t");
+			log_value_print(_stored_type(v), &v->maxs[k * v->width]);
 		}
 
+		debug_printf("\r\n");
+
 		ctx->sample_idx++;
 
-		if (ctx->sample_idx >= LOG_VARIABLE_SAMPLE_DEPTH) {
+		if (ctx->sample_idx >= v->num_samples) {
 			ctx->state = FOOTER;
-		} else {
-			ctx->state = VARIABLES_TS;
 		}
 		break;
+	}
 
 	case FOOTER:
 		debug_printf("-------END-------\r\n\r\n");
-
-		ctx->state = REMOVE_TASK;
-		break;
-
-	case REMOVE_TASK:
-		scheduler_tcb_unregister(&ctx->tcb);
-		break;
+		return JOB_DONE;
 
 	default:
 		// Can't happen
 		HANG;
 		break;
 	}
+
+	return JOB_CONTINUE;
 }
 
 static sm_ctx_t ctx;
 
-void log_var_dump_uart(int log_var_idx)
+int log_var_dump_uart(int log_var_idx)
 {
+	// Only one dump can run at a time, and stream packets
+	// would be spliced into its output
+	if (_dump_is_active() || log_stream_is_running()) {
+		return FAILURE;
+	}
+
+	log_var_t *v = &vars[log_var_idx];
+	if (v->addr == NULL || v->in_group) {
+		return FAILURE;
+	}
+
+	// Compressed blocks must not be reused while being decoded
+	if (v->packed && log_running) {
+		return FAILURE;
+	}
+
 	// Initialize the state machine context
 	ctx.state = TITLE;
 	ctx.var_idx = log_var_idx;
 	ctx.sample_idx = 0;
+	_unpack_start(v, &ctx.cursor);
+
+	// Oldest sample first; the newest is just before 'buffer_idx'
+	ctx.first = (v->buffer_idx - v->num_samples + v->depth) % v->depth;
+
+	// Run the dump in the slack of each time slice
+	job_init(&ctx.job, _dump_step, &ctx, "logdump");
+	return job_start(&ctx.job);
+}
+
+
+
+// ****************
+// Binary dump job
+// ****************
+
+typedef enum bin_states_e {
+	BIN_HEADER = 1,
+	BIN_ARRAYS,
+	BIN_CRC
+} bin_states_e;
+
+typedef struct bin_ctx_t {
+	bin_states_e state;
+	int var_idx;
+	int last_var_idx;
+
+	// Group record still to send, and being sent
+	uint8_t group_pending;
+	uint8_t in_group;
+
+	// Ring arrays of the record being sent
+	int first;
+	int depth;
+	int num_samples;
+	int array_idx;
+	int num_arrays;
+	int sample_idx;
+	pack_cursor_t cursor;
+
+	uint32_t crc;
+	job_t job;
+} bin_ctx_t;
+
+// Bytes handed to the serial driver per step
+#define DUMP_CHUNK_BYTES	(512)
+
+// Compressed samples are decoded into here
+static uint8_t chunk[DUMP_CHUNK_BYTES];
+
+static void _bin_send(bin_ctx_t *ctx, void *data, int len)
+{
+	ctx->crc = crc32_update(ctx->crc, data, len);
+	serial_write((char *) data, len);
+}
+
+// Start and element width of the array being sent
+static uint8_t *_bin_array(bin_ctx_t *ctx, int *width)
+{
+	if (ctx->in_group) {
+		if (ctx->array_idx < 2) {
+			*width = sizeof(uint32_t);
+			return (uint8_t *) ((ctx->array_idx == 0) ? group.block : group.seqs);
+		}
+
+		int c = ctx->array_idx - 2;
+		*width = group.widths[c];
+		return group.values[c];
+	}
+
+	log_var_t *v = &vars[ctx->var_idx];
+
+	if (ctx->array_idx == 0) {
+		*width = sizeof(uint32_t);
+		return (uint8_t *) v->timestamps;
+	}
+
+	uint8_t *arrays[] = {v->values, v->mins, v->maxs};
+	*width = v->width;
+	return arrays[ctx->array_idx - 1];
+}
+
+// Decodes the next samples of a compressed variable and sends
+// one of their arrays; returns number of samples sent
+static int _bin_send_unpacked(bin_ctx_t *ctx)
+{
+	log_var_t *v = &vars[ctx->var_idx];
+
+	// Each array is a separate pass over the blocks
+	if (ctx->sample_idx == 0) {
+		_unpack_start(v, &ctx->cursor);
+	}
+
+	int width = (ctx->array_idx == 0) ? sizeof(uint32_t) : v->width;
+	int n = MIN(DUMP_CHUNK_BYTES / width, ctx->num_samples - ctx->sample_idx);
+
+	for (int i = 0; i < n; i++) {
+		uint32_t timestamp;
+		uint64_t unpacked;
+
+		_unpack_next(v, &ctx->cursor, &timestamp, (uint8_t *) &unpacked);
+
+		if (ctx->array_idx == 0) {
+			memcpy(&chunk[i * width], &timestamp, width);
+		} else {
+			memcpy(&chunk[i * width], &unpacked, width);
+		}
+	}
+
+	_bin_send(ctx, chunk, n * width);
+
+	return n;
+}
+
+// Gathers the next samples of one column of the group's rows
+// (DMA capture) and sends them; returns number of samples sent
+static int _bin_send_column(bin_ctx_t *ctx)
+{
+	int width = sizeof(uint32_t);
+	int offset = ctx->array_idx * sizeof(uint32_t);
+
+	if (ctx->array_idx >= 2) {
+		width = group.widths[ctx->array_idx - 2];
+		offset = group.offsets[ctx->array_idx - 2];
+	}
+
+	int n = MIN(DUMP_CHUNK_BYTES / width, ctx->num_samples - ctx->sample_idx);
+
+	for (int i = 0; i < n; i++) {
+		int k = (ctx->first + ctx->sample_idx + i) % ctx->depth;
+		memcpy(&chunk[i * width], &group.rows[k * group.row_bytes + offset], width);
+	}
+
+	_bin_send(ctx, chunk, n * width);
+
+	return n;
+}
+
+// Sends the next run of the current array, oldest first, up to
+// the end of the ring; returns number of samples sent
+static int _bin_send_chunk(bin_ctx_t *ctx)
+{
+	if (!ctx->in_group && vars[ctx->var_idx].packed) {
+		return _bin_send_unpacked(ctx);
+	}
+
+	if (ctx->in_group && group.dma) {
+		return _bin_send_column(ctx);
+	}
+
+	int width;
+	uint8_t *base = _bin_array(ctx, &width);
+
+	int start = (ctx->first + ctx->sample_idx) % ctx->depth;
+	int n = MIN(DUMP_CHUNK_BYTES / width, ctx->num_samples - ctx->sample_idx);
+	n = MIN(n, ctx->depth - start);
+
+	_bin_send(ctx, &base[start * width], n * width);
+
+	return n;
+}
+
+static void _bin_send_var_header(bin_ctx_t *ctx)
+{
+	log_var_t *v = &vars[ctx->var_idx];
+	log_frame_header_t h = {0};
+
+	h.magic = LOG_FRAME_MAGIC;
+	h.version = LOG_FRAME_VERSION;
+	h.var_idx = ctx->var_idx;
+	h.type = _stored_type(v);
+	h.decim = v->decim;
+	h.num_samples = v->num_samples;
+	h.interval_usec = v->log_interval_usec;
+
+	// Fixed size field, only NUL terminated if the name is shorter
+	memcpy(h.name, v->name, strnlen(v->name, LOG_VAR_NAME_MAX_CHARS));
+
+	// Samples end just before 'buffer_idx'
+	ctx->depth = v->depth;
+	ctx->num_samples = v->num_samples;
+	ctx->first = (v->buffer_idx - v->num_samples + v->depth) % v->depth;
+	ctx->num_arrays = (v->decim == LOG_DECIM_ENVELOPE) ? 4 : 2;
+
+	_bin_send(ctx, &h, sizeof(h));
+}
+
+static void _bin_send_group_header(bin_ctx_t *ctx)
+{
+	log_group_header_t h = {0};
+
+	h.magic = LOG_GROUP_MAGIC;
+	h.version = LOG_FRAME_VERSION;
+	h.num_channels = group.num_channels;
+	h.num_samples = group.num_samples;
+	h.interval_usec = group.log_interval_usec;
+
+	_bin_send(ctx, &h, sizeof(h));
+
+	for (int c = 0; c < group.num_channels; c++) {
+		log_var_t *v = &vars[group.channels[c]];
+		log_group_channel_t ch = {0};
+
+		memcpy(ch.name, v->name, strnlen(v->name, LOG_VAR_NAME_MAX_CHARS));
+		ch.var_idx = group.channels[c];
+		ch.type = v->type;
+
+		_bin_send(ctx, &ch, sizeof(ch));
+	}
+
+	ctx->depth = group.depth;
+	ctx->num_samples = group.num_samples;
+	ctx->first = (group.buffer_idx - group.num_samples + group.depth) % group.depth;
+	ctx->num_arrays = 2 + group.num_channels;
+}
+
+static job_status_e _bin_dump_step(void *arg)
+{
+	bin_ctx_t *ctx = (bin_ctx_t *) arg;
+
+	// Wait for UART to drain so no output is lost
+	if (serial_get_free_space() < DUMP_CHUNK_BYTES) {
+		return JOB_YIELD;
+	}
+
+	switch (ctx->state) {
+	case BIN_HEADER:
+		// Skip unused slots, group channels and stats-only
+		// variables (no samples) when dumping everything
+		while (ctx->var_idx <= ctx->last_var_idx
+				&& (vars[ctx->var_idx].addr == NULL || vars[ctx->var_idx].in_group
+					|| vars[ctx->var_idx].stats_only)) {
+			ctx->var_idx++;
+		}
+
+		ctx->crc = 0;
+		ctx->array_idx = 0;
+		ctx->sample_idx = 0;
+
+		if (ctx->var_idx <= ctx->last_var_idx) {
+			_bin_send_var_header(ctx);
+		} else if (ctx->group_pending) {
+			ctx->group_pending = 0;
+			ctx->in_group = 1;
+			_bin_send_group_header(ctx);
+		} else {
+			return JOB_DONE;
+		}
+
+		ctx->state = BIN_ARRAYS;
+		break;
+
+	case BIN_ARRAYS:
+	{
+		ctx->sample_idx += _bin_send_chunk(ctx);
+
+		if (ctx->sample_idx >= ctx->num_samples) {
+			ctx->sample_idx = 0;
+			ctx->array_idx++;
+
+			if (ctx->array_idx >= ctx->num_arrays) {
+				ctx->state = BIN_CRC;
+			}
+		}
+		break;
+	}
+
+	case BIN_CRC:
+		serial_write((char *) &ctx->crc, sizeof(ctx->crc));
+
+		if (ctx->in_group) {
+			ctx->in_group = 0;
+		} else {
+			ctx->var_idx++;
+		}
+
+		ctx->state = BIN_HEADER;
+		break;
+
+	default:
+		// Can't happen
+		HANG;
+		break;
+	}
+
+	return JOB_CONTINUE;
+}
+
+static bin_ctx_t bin_ctx;
+
+static uint8_t _dump_is_active(void)
+{
+	return job_is_active(&ctx.job) || job_is_active(&bin_ctx.job);
+}
+
+uint8_t log_dump_is_active(void)
+{
+	return _dump_is_active();
+}
+
+int log_var_dump_uart_binary(int log_var_idx)
+{
+	// Only one dump can run at a time, and stream packets
+	// would be spliced into its output
+	if (_dump_is_active() || log_stream_is_running()) {
+		return FAILURE;
+	}
+
+	// Compressed blocks must not be reused while being decoded
+	if (log_running) {
+		for (int i = 0; i < LOG_MAX_NUM_VARS; i++) {
+			if (vars[i].packed && vars[i].addr != NULL && !vars[i].in_group
+					&& (log_var_idx == LOG_DUMP_ALL || log_var_idx == i)) {
+				return FAILURE;
+			}
+		}
+	}
+
+	// Nothing to send yet unless chosen below
+	bin_ctx.var_idx = 0;
+	bin_ctx.last_var_idx = -1;
+	bin_ctx.group_pending = 0;
+	bin_ctx.in_group = 0;
+
+	if (log_var_idx == LOG_DUMP_ALL) {
+		bin_ctx.last_var_idx = LOG_MAX_NUM_VARS - 1;
+		bin_ctx.group_pending = (group.num_channels > 0);
+	} else if (log_var_idx == LOG_DUMP_GROUP) {
+		if (group.num_channels == 0) {
+			return FAILURE;
+		}
+
+		bin_ctx.group_pending = 1;
+	} else {
+		if (vars[log_var_idx].addr == NULL || vars[log_var_idx].in_group
+				|| vars[log_var_idx].stats_only) {
+			return FAILURE;
+		}
+
+		bin_ctx.var_idx = log_var_idx;
+		bin_ctx.last_var_idx = log_var_idx;
+	}
+
+	bin_ctx.state = BIN_HEADER;
 
-	// Initialize the state machine callback tcb
-	scheduler_tcb_init(&ctx.tcb, state_machine_callback, &ctx, "logdump", SM_INTERVAL_USEC);
-	scheduler_tcb_register(&ctx.tcb);
+	// Send as fast as the UART drains
+	job_init(&bin_ctx.job, _bin_dump_step, &bin_ctx, "logdumpbin");
+	return job_start(&bin_ctx.job);
 }
@@ -4,18 +4,113 @@
 #include <stdint.h>
 #include "scheduler.h"
 
-#define LOG_MAX_NUM_VARS				(8)
+#define LOG_MAX_NUM_VARS				(32)
+
+// Default samples kept per variable; 'log reg' can ask for more
+// or less, from an arena of DDR shared by all variables
 #define LOG_VARIABLE_SAMPLE_DEPTH		(10000)
+#define LOG_VAR_NAME_MAX_CHARS			(16)
+
+#define LOG_GROUP_MAX_CHANNELS			(16)
+#define LOG_DMA_BATCH_ROWS				(32)
+#define LOG_STATS_MAX_BINS				(32)
 
 #define LOG_UPDATES_PER_SEC				SYS_TICK_FREQ
 #define LOG_INTERVAL_USEC				(USEC_IN_SEC / LOG_UPDATES_PER_SEC)
 
+// Logged values are stored at the width of their type,
+// so narrow types take less of the arena
 typedef enum var_type_e {
-	INT = 1,
+	INT = 1,	// int32_t
 	FLOAT,
-	DOUBLE
+	DOUBLE,
+	INT8,
+	UINT8,
+	INT16,
+	UINT16,
+	UINT32,
+	INT64,
+	UINT64
 } var_type_e;
 
+// Trigger conditions, checked on each new sample of the
+// trigger variable
+typedef enum log_trig_e {
+	LOG_TRIG_RISING = 1,	// crosses level going up
+	LOG_TRIG_FALLING,		// crosses level going down
+	LOG_TRIG_WINDOW,		// leaves [level, level_hi]
+	LOG_TRIG_SOFTWARE		// only log_trigger()
+} log_trig_e;
+
+// Decimation from the log task rate down to a variable's
+// samples_per_sec, instead of sample-and-hold. Decimated
+// variables are stored as float, or as double if they are 64-bit
+typedef enum log_decim_e {
+	LOG_DECIM_NONE = 1,	// sample-and-hold
+	LOG_DECIM_MEAN,		// boxcar average over each output interval
+	LOG_DECIM_CIC,		// second order CIC (sinc^2), better alias rejection
+	LOG_DECIM_ENVELOPE	// min, max and mean of each output interval
+} log_decim_e;
+
+// Binary dump
+//
+// 'log dump bin' sends one frame per variable, all fields little-endian:
+//
+//   log_frame_header_t
+//   uint32_t timestamps[num_samples]   -- usec, oldest first
+//   values[num_samples]                -- packed at the width of 'type'
+//   mins[num_samples]                  -- LOG_DECIM_ENVELOPE only
+//   maxs[num_samples]                  -- LOG_DECIM_ENVELOPE only
+//   uint32_t crc32                     -- CRC-32 of everything above
+//
+// The group is sent as one frame with one row per sample:
+//
+//   log_group_header_t
+//   log_group_channel_t channels[num_channels]
+//   uint32_t timestamps[num_samples]
+//   uint32_t seqs[num_samples]
+//   values[num_channels][num_samples]  -- each at its channel's width
+//   uint32_t crc32
+//
+// Frames can be mixed with console text; tools/log2csv.py finds them by
+// the magic number and drops any whose CRC does not match.
+//
+#define LOG_FRAME_MAGIC		(0x4C444D41) // "AMDL"
+#define LOG_GROUP_MAGIC		(0x47444D41) // "AMDG"
+#define LOG_FRAME_VERSION	(2)
+
+// Pass as the index to dump every registered variable and the group,
+// or just the group
+#define LOG_DUMP_ALL		(-1)
+#define LOG_DUMP_GROUP		(-2)
+
+typedef struct log_frame_header_t {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t var_idx;
+	uint8_t type;
+	uint8_t decim;
+	uint32_t num_samples;
+	uint32_t interval_usec;
+	char name[LOG_VAR_NAME_MAX_CHARS];
+} log_frame_header_t;
+
+typedef struct log_group_header_t {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t num_channels;
+	uint16_t reserved;
+	uint32_t num_samples;
+	uint32_t interval_usec; // 0 when sampled by log_sample_now()
+} log_group_header_t;
+
+typedef struct log_group_channel_t {
+	char name[LOG_VAR_NAME_MAX_CHARS];
+	uint8_t var_idx;
+	uint8_t type;
+	uint16_t reserved;
+} log_group_channel_t;
+
 void log_init(void);
 void log_callback(void *arg);
 
@@ -23,8 +118,113 @@ void log_start(void);
 void log_stop(void);
 uint8_t log_is_logging(void);
 
-void log_var_register(int idx, char* name, void *addr, uint32_t samples_per_sec, var_type_e type);
+// Triggered capture
+//
+// With a trigger set, 'log start' arms it and all buffers record
+// continuously. Once it fires, each variable takes 'post_samples' more
+// samples and then freezes, keeping the rest of its depth as history
+// from before the trigger. Logging stops by itself when all are frozen.
+//
+int log_trig_set(log_trig_e mode, int idx, float level, float level_hi, int post_samples);
+void log_trig_off(void);
+
+// Fires an armed trigger of any mode (commands, fault handlers);
+// safe from ISRs
+int log_trigger(void);
+
+// Coherent group sampling
+//
+// Registered variables can be moved into a group, which samples all of
+// them in the same instant and stores one timestamp and sequence number
+// per row instead of one timestamp per value. With samples_per_sec = 0,
+// rows are only taken when the application calls log_sample_now(), e.g.
+// at the end of a control loop, so all channels come from the same
+// iteration. Grouped variables are not sampled on their own, and must
+// be plain: not decimated, compressed or stats-only.
+//
+int log_group_set(uint32_t samples_per_sec, int depth, int *idxs, int num_channels);
+int log_group_off(void);
+
+// DMA capture of the group
+//
+// Instead of writing each row into the arena, the sampler packs it
+// into a small staging buffer, which stays in the data cache, and every
+// LOG_DMA_BATCH_ROWS rows the PS DMA controller moves the batch into
+// the arena while the CPU carries on. Per row, the CPU then only reads
+// the channels and bumps a counter, with no stores spread over the
+// arena and no ring bookkeeping. Rows show up in dumps (same format)
+// once their batch has landed; 'log stop' and a trigger freeze send
+// the rows still staged. A batch which finds the DMA still busy with
+// the one before is dropped, seen as a gap in 'seq'. Switching mode
+// empties the group.
+//
+int log_group_set_dma(uint8_t enable);
+
+// Also feeds the stream when it was started with rate 'now'
+// (see log_stream.h). Safe from RT tasks
+void log_sample_now(void);
+
+// Returns FAILURE if the log arena has no room for 'depth' samples,
+// or while a dump is running
+int log_var_register(int idx, char* name, void *addr, uint32_t samples_per_sec, int depth, var_type_e type);
 void log_var_empty(int idx);
-void log_var_dump_uart(int idx);
+
+// Also empties the log of the variable
+int log_var_set_decim(int idx, log_decim_e decim);
+
+// Compressed logging
+//
+// Stores each sample as varint deltas from the one before, in blocks
+// of the variable's existing arena space, so slowly changing signals
+// (positions, bus voltage, temperatures) keep several times more
+// history. How many samples fit depends on the signal; the oldest
+// block is given up when the space is full. Samples are decoded when
+// dumped, so dump output is the same as uncompressed. Not available
+// for LOG_DECIM_ENVELOPE, and empties the log of the variable.
+//
+int log_var_set_compress(int idx, uint8_t enable);
+
+// Statistics-only logging
+//
+// Instead of storing samples, keeps the count, sum, sum of squares,
+// min and max of the variable over every log tick while logging, and
+// optionally a histogram of 'num_bins' equal bins over [lo, hi), in
+// constant memory. Meant for long runs where only e.g. RMS current or
+// peak speed matter. Results build up until the log is emptied.
+// Stats-only variables can't be trigger sources.
+//
+int log_var_set_stats(int idx, uint8_t enable, double lo, double hi, int num_bins);
+
+// Prints mean, RMS, std dev, min and max of all stats-only
+// variables, or with the histogram for just one
+int log_stats_print(int idx);
+
+// Access to registered variables for other log front-ends
+// (log_stream.c); read copies the current value at its native
+// width and fails if the variable isn't registered
+int log_var_read(int idx, void *value);
+var_type_e log_var_get_type(int idx);
+const char *log_var_get_name(int idx);
+
+// Bytes per value of 'type', 0 if unknown
+int log_type_get_width(var_type_e type);
+
+// Names used by commands ("int8", ..., "double"); "int" is int32.
+// Returns 0 for an unknown name
+var_type_e log_type_from_name(const char *name);
+const char *log_type_get_name(var_type_e type);
+
+// Prints a value of 'type' with debug_printf()
+void log_value_print(var_type_e type, const void *value);
+
+// Unregisters all variables and frees the whole arena;
+// FAILURE while logging or dumping
+int log_reset(void);
+uint32_t log_get_arena_free(void);
+void log_info_print(void);
+// Dumps and the stream share the UART, so only one runs at a time
+int log_var_dump_uart(int idx);
+int log_var_dump_uart_binary(int idx);
+uint8_t log_dump_is_active(void);
 
 #endif // LOG_H
@@ -0,0 +1,344 @@
+#include "log_stream.h"
+#include "log.h"
+#include "crc32.h"
+#include "debug.h"
+#include "defines.h"
+#include "job.h"
+#include "scheduler.h"
+#include "serial.h"
+#include "../drv/cpu_timer.h"
+#include <string.h>
+
+// Min time between two rate cuts, so the ring can drain
+// and show the effect of the last one
+#define CLAMP_HOLD_USEC		(100000)
+
+static int channels[LOG_STREAM_MAX_CHANNELS];
+static uint8_t widths[LOG_STREAM_MAX_CHANNELS];
+static int num_channels = 0;
+
+// Base interval requested by the user, 0 when fed by log_sample_now()
+static uint32_t interval_usec;
+
+static uint32_t ring[LOG_STREAM_RING_WORDS];
+static int row_words;
+static uint32_t capacity;
+
+// Rows ever written (producer) and read (consumer);
+// slot is the count mod 'capacity'
+static volatile uint32_t head;
+static volatile uint32_t tail;
+
+static volatile uint8_t running = 0;
+
+// Written by the consumer, read by the producer
+static volatile uint32_t clamp;
+
+// Producer state
+static uint64_t last_usec;
+static uint32_t now_count;
+static uint32_t seq;
+static volatile uint32_t dropped;
+
+// Consumer state
+static uint32_t packet_seq;
+static uint32_t packets_since_descriptor;
+static uint32_t rows_sent;
+static uint32_t max_fill;
+static uint32_t last_dropped;
+static uint64_t last_clamp_usec;
+static uint32_t last_clamp_fill;
+static uint64_t relax_since_usec;
+
+static uint32_t packet[LOG_STREAM_PACKET_BYTES / sizeof(uint32_t)];
+
+static job_t job;
+
+
+static void _push(uint32_t timestamp)
+{
+	uint32_t h = head;
+	uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+	uint32_t s = seq++;
+
+	if (h - t >= capacity) {
+		// Never wait for the link
+		dropped++;
+		return;
+	}
+
+	uint32_t *row = &ring[(h % capacity) * row_words];
+	row[0] = s;
+	row[1] = timestamp;
+
+	// Values are packed, so zero the padding at the end of the row
+	row[row_words - 1] = 0;
+
+	uint8_t *value = (uint8_t *) &row[2];
+	for (int c = 0; c < num_channels; c++) {
+		log_var_read(channels[c], value);
+		value += widths[c];
+	}
+
+	// Publish the row only once it is complete
+	__atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+}
+
+void log_stream_tick(void)
+{
+	if (!running || interval_usec == 0) {
+		return;
+	}
+
+	uint64_t now = scheduler_get_elapsed_usec();
+
+	if (now - last_usec >= (uint64_t) interval_usec * clamp) {
+		last_usec = now;
+		_push((uint32_t) cpu_timer_get_usec());
+	}
+}
+
+void log_stream_sample_now(void)
+{
+	if (!running || interval_usec != 0) {
+		return;
+	}
+
+	// Keep every 'clamp'-th row
+	if (++now_count < clamp) {
+		return;
+	}
+
+	now_count = 0;
+	_push((uint32_t) cpu_timer_get_usec());
+}
+
+// Cuts the rate quickly while the backlog keeps growing past half the
+// ring or rows are dropped, and raises it slowly once the link has kept
+// up for a while. A backlog which is already shrinking is left to drain.
+static void _adapt(uint32_t fill)
+{
+	uint64_t now = scheduler_get_elapsed_usec();
+	uint32_t d = dropped;
+
+	max_fill = MAX(max_fill, fill);
+
+	if ((fill > capacity / 2 && fill > last_clamp_fill) || d != last_dropped) {
+		last_dropped = d;
+		relax_since_usec = now;
+
+		if (clamp < LOG_STREAM_MAX_CLAMP && now - last_clamp_usec >= CLAMP_HOLD_USEC) {
+			clamp *= 2;
+			last_clamp_usec = now;
+			last_clamp_fill = fill;
+		}
+	} else if (fill > capacity / 8) {
+		relax_since_usec = now;
+
+		if (fill <= capacity / 2) {
+			last_clamp_fill = 0;
+		}
+	} else if (clamp > 1 && now - relax_since_usec >= LOG_STREAM_RELAX_USEC) {
+		clamp /= 2;
+		relax_since_usec = now;
+	}
+}
+
+static int _fill_header(uint8_t flags, uint16_t num_rows)
+{
+	log_stream_header_t *h = (log_stream_header_t *) packet;
+
+	memset(h, 0, sizeof(*h));
+	h->magic = LOG_STREAM_MAGIC;
+	h->version = LOG_STREAM_VERSION;
+	h->flags = flags;
+	h->num_channels = num_channels;
+	h->packet_seq = packet_seq++;
+	h->dropped = dropped;
+	h->interval_usec = interval_usec * clamp;
+	h->num_rows = num_rows;
+	h->clamp = clamp;
+
+	return sizeof(*h);
+}
+
+static void _send(int len)
+{
+	uint32_t crc = crc32_update(0, packet, len);
+
+	serial_write((char *) packet, len);
+	serial_write((char *) &crc, sizeof(crc));
+}
+
+static void _send_descriptor(void)
+{
+	int len = _fill_header(LOG_STREAM_DESCRIPTOR, 0);
+
+	for (int c = 0; c < num_channels; c++) {
+		log_group_channel_t *ch = (log_group_channel_t *) ((uint8_t *) packet + len);
+
+		memset(ch, 0, sizeof(*ch));
+		strncpy(ch->name, log_var_get_name(channels[c]), LOG_VAR_NAME_MAX_CHARS);
+		ch->var_idx = channels[c];
+		ch->type = log_var_get_type(channels[c]);
+
+		len += sizeof(*ch);
+	}
+
+	_send(len);
+}
+
+static job_status_e _stream_step(void *arg)
+{
+	if (!running) {
+		return JOB_DONE;
+	}
+
+	uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+	uint32_t avail = h - tail;
+
+	_adapt(avail);
+
+	// Keep at most about two packets queued for the UART: the backlog
+	// then builds up in the ring, where _adapt() sees it, and command
+	// output is not held up behind seconds of stream data
+	if (serial_get_pending() > LOG_STREAM_PACKET_BYTES
+		|| serial_get_free_space() < LOG_STREAM_PACKET_BYTES + (int) sizeof(uint32_t)) {
+		return JOB_YIELD;
+	}
+
+	if (packets_since_descriptor >= LOG_STREAM_DESCRIPTOR_EVERY) {
+		packets_since_descriptor = 0;
+		_send_descriptor();
+		return JOB_CONTINUE;
+	}
+
+	if (avail == 0) {
+		return JOB_YIELD;
+	}
+
+	int max_rows = (sizeof(packet) - sizeof(log_stream_header_t)) / (row_words * sizeof(uint32_t));
+	uint32_t n = MIN(avail, (uint32_t) max_rows);
+
+	int len = _fill_header(0, n);
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t *row = &ring[((tail + i) % capacity) * row_words];
+		memcpy((uint8_t *) packet + len, row, row_words * sizeof(uint32_t));
+		len += row_words * sizeof(uint32_t);
+	}
+
+	// Hand the slots back to the producer
+	__atomic_store_n(&tail, tail + n, __ATOMIC_RELEASE);
+
+	_send(len);
+	rows_sent += n;
+	packets_since_descriptor++;
+
+	return JOB_CONTINUE;
+}
+
+int log_stream_start(uint32_t samples_per_sec, int *idxs, int n)
+{
+	// Previous stream's job might still be winding down, and
+	// packets would be spliced into a dump's output
+	if (running || job_is_active(&job) || log_dump_is_active()) {
+		return FAILURE;
+	}
+
+	if (n <= 0 || n > LOG_STREAM_MAX_CHANNELS) {
+		return FAILURE;
+	}
+
+	int row_bytes = 0;
+
+	for (int c = 0; c < n; c++) {
+		uint64_t value;
+		if (idxs[c] < 0 || idxs[c] >= LOG_MAX_NUM_VARS || log_var_read(idxs[c], &value) != SUCCESS) {
+			return FAILURE;
+		}
+
+		channels[c] = idxs[c];
+		widths[c] = log_type_get_width(log_var_get_type(idxs[c]));
+		row_bytes += widths[c];
+	}
+
+	num_channels = n;
+	row_words = 2 + (row_bytes + 3) / 4;
+	capacity = LOG_STREAM_RING_WORDS / row_words;
+	interval_usec = (samples_per_sec > 0) ? (USEC_IN_SEC / samples_per_sec) : 0;
+
+	head = 0;
+	tail = 0;
+	clamp = 1;
+
+	last_usec = 0;
+	now_count = 0;
+	seq = 0;
+	dropped = 0;
+
+	packet_seq = 0;
+	rows_sent = 0;
+	max_fill = 0;
+	last_dropped = 0;
+	last_clamp_usec = 0;
+	last_clamp_fill = 0;
+	relax_since_usec = scheduler_get_elapsed_usec();
+
+	// Descriptor goes out first
+	packets_since_descriptor = LOG_STREAM_DESCRIPTOR_EVERY;
+
+	__atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+
+	job_init(&job, _stream_step, NULL, "logstream");
+	return job_start(&job);
+}
+
+int log_stream_stop(void)
+{
+	if (!running) {
+		return FAILURE;
+	}
+
+	// Rows still in the ring are discarded
+	running = 0;
+	return SUCCESS;
+}
+
+uint8_t log_stream_is_running(void)
+{
+	return running;
+}
+
+uint8_t log_stream_has_var(int idx)
+{
+	if (!running) {
+		return 0;
+	}
+
+	for (int c = 0; c < num_channels; c++) {
+		if (channels[c] == idx) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void log_stream_stats_print(void)
+{
+	if (num_channels == 0) {
+		debug_printf("Stream: never started\r\n");
+		return;
+	}
+
+	debug_printf("Stream: %s, %d channels", running ? "running" : "stopped", num_channels);
+	if (interval_usec != 0) {
+		debug_printf(" at %lu Hz", USEC_IN_SEC / (interval_usec * clamp));
+	} else {
+		debug_printf(" on log_sample_now()");
+	}
+	debug_printf(", rate 1/%lu of requested\r\n", clamp);
+
+	debug_printf("Rows: %lu sent, %lu dropped\r\n", rows_sent, dropped);
+	debug_printf("Ring: %lu / %lu rows used, max %lu\r\n", head - tail, capacity, max_fill);
+}
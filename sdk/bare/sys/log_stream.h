@@ -0,0 +1,75 @@
+#ifndef LOG_STREAM_H
+#define LOG_STREAM_H
+
+#include <stdint.h>
+
+// Streaming log
+//
+// Sends registered log variables over the UART continuously, for runs
+// too long to capture in memory. Rows of {seq, timestamp, values...} are
+// written into a lock-free single-producer / single-consumer ring by the
+// log task, or by log_sample_now() from a control task. A background job
+// drains the ring into CRC-checked packets as fast as the UART allows.
+//
+// Nothing blocks the producer: when the ring is full the row is dropped
+// and counted. If the ring keeps filling up, the rate is halved (down to
+// 1 / LOG_STREAM_MAX_CLAMP of the requested rate) and raised again once
+// the link has kept up for LOG_STREAM_RELAX_USEC. Each row keeps its
+// sequence number, so the host sees exactly which rows are missing.
+//
+// Packets, all fields little-endian:
+//
+//   log_stream_header_t
+//   log_group_channel_t channels[num_channels]   -- LOG_STREAM_DESCRIPTOR
+//   or rows[num_rows] of:
+//     uint32_t seq
+//     uint32_t timestamp                         -- usec
+//     values[num_channels]                       -- each at its channel's width,
+//                                                   zero padded to 4 bytes
+//   uint32_t crc32                               -- CRC-32 of everything above
+//
+// A descriptor packet is sent first and every LOG_STREAM_DESCRIPTOR_EVERY
+// packets, so a host which starts listening late can decode the stream.
+// tools/log2csv.py writes the rows to stream.csv.
+//
+#define LOG_STREAM_MAGIC			(0x53444D41) // "AMDS"
+#define LOG_STREAM_VERSION			(2)
+
+#define LOG_STREAM_MAX_CHANNELS		(16)
+#define LOG_STREAM_RING_WORDS		(16 * 1024)
+#define LOG_STREAM_PACKET_BYTES		(512)
+#define LOG_STREAM_DESCRIPTOR_EVERY	(64)
+
+#define LOG_STREAM_MAX_CLAMP		(256)	// Must be a power of 2
+#define LOG_STREAM_RELAX_USEC		(1000000)
+
+// Header flags
+#define LOG_STREAM_DESCRIPTOR		(1 << 0)
+
+typedef struct log_stream_header_t {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t flags;
+	uint8_t num_channels;
+	uint8_t reserved;
+	uint32_t packet_seq;
+	uint32_t dropped;		// rows lost to a full ring since start
+	uint32_t interval_usec;	// after clamping; 0 when fed by log_sample_now()
+	uint16_t num_rows;
+	uint16_t clamp;			// requested rate / current rate
+} log_stream_header_t;
+
+// samples_per_sec = 0 streams one row per log_sample_now() call
+int log_stream_start(uint32_t samples_per_sec, int *idxs, int num_channels);
+int log_stream_stop(void);
+uint8_t log_stream_is_running(void);
+
+// 1 while the stream reads variable 'idx', which must keep its type
+uint8_t log_stream_has_var(int idx);
+void log_stream_stats_print(void);
+
+// Producers, called by the log engine
+void log_stream_tick(void);
+void log_stream_sample_now(void);
+
+#endif // LOG_STREAM_H
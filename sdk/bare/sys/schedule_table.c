@@ -0,0 +1,163 @@
+#include "schedule_table.h"
+#include "defines.h"
+#include <stdbool.h>
+
+// Flat list of all table entries; slot 'i' holds
+// entries[slot_start[i]] .. entries[slot_start[i+1] - 1]
+static task_control_block_t *entries[SCHED_TABLE_MAX_ENTRIES];
+static uint32_t slot_start[SCHED_TABLE_MAX_SLOTS + 1];
+
+// Number of tasks placed in each slot while building
+static uint16_t slot_load[SCHED_TABLE_MAX_SLOTS];
+
+static uint32_t num_slots = 0;
+static uint32_t max_slot_size = 0;
+
+static uint32_t _gcd(uint32_t a, uint32_t b)
+{
+	while (b != 0) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+static uint32_t _period_ticks(task_control_block_t *t)
+{
+	// Round up to match the list walk, which runs a
+	// task once at least 'interval_usec' has elapsed
+	uint32_t period = (uint32_t) ((t->interval_usec + SYS_TICK_USEC - 1) / SYS_TICK_USEC);
+	return MAX(period, 1);
+}
+
+// Picks the phase in [0, period) whose slots are least loaded,
+// only considering phases 'first', 'first + step', ...
+static uint32_t _find_phase(uint32_t period, uint32_t hyperperiod, uint32_t first, uint32_t step)
+{
+	uint32_t best_phase = first;
+	uint32_t best_load = UINT32_MAX;
+
+	for (uint32_t phase = first; phase < period; phase += step) {
+		uint32_t load = 0;
+		for (uint32_t slot = phase; slot < hyperperiod; slot += period) {
+			load = MAX(load, slot_load[slot]);
+		}
+
+		if (load < best_load) {
+			best_load = load;
+			best_phase = phase;
+		}
+	}
+
+	return best_phase;
+}
+
+int schedule_table_build(task_control_block_t *tasks)
+{
+	task_control_block_t *list[SCHED_TABLE_MAX_TASKS];
+	uint32_t period[SCHED_TABLE_MAX_TASKS];
+	uint32_t phase[SCHED_TABLE_MAX_TASKS];
+	bool placed[SCHED_TABLE_MAX_TASKS];
+	int n = 0;
+
+	// Collect tasks and find the hyperperiod
+	uint32_t hyperperiod = 1;
+	uint32_t total_entries = 0;
+
+	for (task_control_block_t *t = tasks; t != NULL; t = t->next) {
+		if (n >= SCHED_TABLE_MAX_TASKS) return FAILURE;
+
+		list[n] = t;
+		period[n] = _period_ticks(t);
+		placed[n] = false;
+
+		uint32_t step = period[n] / _gcd(hyperperiod, period[n]);
+		if (hyperperiod > SCHED_TABLE_MAX_SLOTS / step) return FAILURE;
+		hyperperiod *= step;
+
+		n++;
+	}
+
+	for (int i = 0; i < n; i++) {
+		total_entries += hyperperiod / period[i];
+	}
+	if (total_entries > SCHED_TABLE_MAX_ENTRIES) return FAILURE;
+
+	// Assign phases, shortest periods first as they have
+	// the least freedom in where they can be placed. Ties go
+	// to the earlier task, so producers are placed first.
+	for (uint32_t slot = 0; slot < hyperperiod; slot++) {
+		slot_load[slot] = 0;
+	}
+
+	for (int k = 0; k < n; k++) {
+		// Find shortest period task not yet placed
+		int next = -1;
+		for (int i = 0; i < n; i++) {
+			if (placed[i]) continue;
+			if (next < 0 || period[i] < period[next]) next = i;
+		}
+
+		// Stay phase aligned to a producer whose period divides ours
+		uint32_t first = 0;
+		uint32_t step = 1;
+		for (int d = 0; d < list[next]->num_deps; d++) {
+			for (int i = 0; i < n; i++) {
+				if (list[i] == list[next]->deps[d] && placed[i] && period[next] % period[i] == 0) {
+					first = phase[i];
+					step = period[i];
+				}
+			}
+		}
+
+		phase[next] = _find_phase(period[next], hyperperiod, first, step);
+		for (uint32_t slot = phase[next]; slot < hyperperiod; slot += period[next]) {
+			slot_load[slot]++;
+		}
+
+		placed[next] = true;
+	}
+
+	// Lay out slots back to back
+	max_slot_size = 0;
+	slot_start[0] = 0;
+	for (uint32_t slot = 0; slot < hyperperiod; slot++) {
+		slot_start[slot + 1] = slot_start[slot] + slot_load[slot];
+		max_slot_size = MAX(max_slot_size, slot_load[slot]);
+
+		// Reuse load as fill count below
+		slot_load[slot] = 0;
+	}
+
+	// Fill slots in list order, so tasks which are due in the same
+	// tick run in dependency order, then registration order
+	for (int i = 0; i < n; i++) {
+		for (uint32_t slot = phase[i]; slot < hyperperiod; slot += period[i]) {
+			entries[slot_start[slot] + slot_load[slot]++] = list[i];
+		}
+	}
+
+	num_slots = hyperperiod;
+
+	return SUCCESS;
+}
+
+void schedule_table_get_slot(uint32_t tick, task_control_block_t ***slot_entries, uint32_t *num_entries)
+{
+	uint32_t slot = tick % num_slots;
+
+	*slot_entries = &entries[slot_start[slot]];
+	*num_entries = slot_start[slot + 1] - slot_start[slot];
+}
+
+uint32_t schedule_table_get_num_slots(void)
+{
+	return num_slots;
+}
+
+uint32_t schedule_table_get_max_slot_size(void)
+{
+	return max_slot_size;
+}
@@ -0,0 +1,33 @@
+#ifndef SCHEDULE_TABLE_H
+#define SCHEDULE_TABLE_H
+
+#include <stdint.h>
+#include "scheduler.h"
+
+// Cyclic executive schedule table
+//
+// The table covers one hyperperiod (LCM of all task periods, in SysTicks).
+// Each slot holds the exact list of tasks to run in that SysTick, so the
+// per-tick cost is O(tasks due) instead of O(tasks registered).
+//
+// Tasks with the same period are phase-staggered across slots so their
+// load is spread out instead of piling onto one slot. A task stays phase
+// aligned to its producers whose periods divide its own.
+//
+#define SCHED_TABLE_MAX_SLOTS		(SYS_TICK_FREQ)	// 1 sec hyperperiod
+#define SCHED_TABLE_MAX_ENTRIES		(64 * 1024)
+#define SCHED_TABLE_MAX_TASKS		(64)
+
+// Builds the table from the linked list of registered tasks.
+//
+// Returns SUCCESS, or FAILURE if the hyperperiod or number
+// of entries does not fit in the table.
+int schedule_table_build(task_control_block_t *tasks);
+
+// Gets the list of tasks to run in the SysTick 'tick'
+void schedule_table_get_slot(uint32_t tick, task_control_block_t ***entries, uint32_t *num_entries);
+
+uint32_t schedule_table_get_num_slots(void);
+uint32_t schedule_table_get_max_slot_size(void);
+
+#endif // SCHEDULE_TABLE_H
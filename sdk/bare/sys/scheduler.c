@@ -1,8 +1,32 @@
 #include "scheduler.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include "debug.h"
+#include "job.h"
+#include "schedule_table.h"
+#include "symbols.h"
+#include "timers.h"
+#include "trace.h"
+#include "cmd/cmd_sched.h"
+#include "../drv/cpu_timer.h"
 #include "../drv/io.h"
 #include "../drv/timer.h"
+#include "xil_exception.h"
+
+// Number of CPU timer ticks available in one scheduler time slice
+#define SYS_TICK_BUDGET_TICKS	(SYS_TICK_USEC * CPU_TIMER_TICKS_PER_USEC)
+
+// Slack in each slice which is handed to background jobs
+#define JOB_BUDGET_TICKS		(SYS_TICK_BUDGET_TICKS - (JOB_SLACK_MARGIN_USEC * CPU_TIMER_TICKS_PER_USEC))
+
+// Sleep until the next interrupt is pending. Wakes up even
+// if IRQs are masked, which is what makes the idle loop race-free.
+#ifdef AMDC_SIM
+#define WFI()	sim_wait_for_interrupt()
+#else
+#define WFI()	__asm__ __volatile__ ("wfi" : : : "memory")
+#endif
 
 // Used to give each task a unique ID
 static int next_tcb_id = 0;
@@ -10,37 +34,150 @@ static int next_tcb_id = 0;
 // Linked list of all registered tasks
 static task_control_block_t *tasks = NULL;
 
+// Linked list of event-driven tasks, see scheduler_tcb_register_event()
+static task_control_block_t *event_tasks = NULL;
+
+// Real-time tier: tasks run directly from the SysTick ISR.
+// Unused slots are NULL so the ISR never sees a half-updated list.
+static task_control_block_t *volatile rt_tasks[SCHED_RT_MAX_TASKS] = {0};
+
 // For debugging, this variable is set to point
 // at the currently running task
 static task_control_block_t *running_task = NULL;
 
 // Incremented every SysTick interrupt to track time
-static uint64_t elapsed_usec = 0;
+static volatile uint64_t elapsed_usec = 0;
+static volatile uint32_t elapsed_ticks = 0;
+
+// CPU timer value at the start of the last SysTick interrupt,
+// used to measure how late each task starts
+static volatile uint32_t tick_stamp = 0;
+
+// How the scheduler finds tasks which are due, see scheduler_set_mode()
+static sched_mode_e mode = SCHED_MODE_LIST;
+
+// Set when the list of tasks changes, so the schedule
+// table is rebuilt before the next time slice
+static bool table_dirty = true;
+
+// Set when tasks or dependencies change, so the task list
+// is put in dependency order before the next time slice
+static bool order_dirty = false;
 
 static bool tasks_running = false;
 static volatile bool scheduler_idle = false;
 
+// Overrun bookkeeping, see overrun policy in scheduler.h
+static volatile bool overrun_in_slice = false;
+static volatile uint32_t consecutive_overruns = 0;
+static volatile uint32_t total_overruns = 0;
+static volatile uint32_t shed_ticks = 0;
+
+// CPU utilization bookkeeping, see _idle()
+static uint32_t window_idle_ticks = 0;
+static uint32_t window_start_ticks = 0;
+static uint32_t window_start_slice = 0;
+static uint32_t max_busy_ticks = 0;
+
+// Rolling CPU load (percent), updated every SCHED_LOAD_WINDOW_SLICES.
+// Exported so it can be registered with the logging engine by name.
+double LOG_sched_cpu_load = 0.0;
+SYMBOL_EXPORT(LOG_sched_cpu_load, DOUBLE);
+
+static void _latch_overrun_fault(void)
+{
+	printf("ERROR: OVERRUN SCHEDULER TIME QUANTUM!\n");
+	io_led_color_t color;
+	color.r = 255;
+	color.g = 0;
+	color.b = 0;
+	io_led_set(&color);
+	HANG;
+}
+
+static void _stats_update(task_stats_t *stats, uint32_t ticks);
+
+static void _run_rt_tasks(void)
+{
+	uint32_t tier_start = cpu_timer_now();
+
+	for (int i = 0; i < SCHED_RT_MAX_TASKS; i++) {
+		task_control_block_t *t = rt_tasks[i];
+		if (t == NULL) continue;
+
+		uint64_t usec_since_last_run = elapsed_usec - t->last_run_usec;
+		if (usec_since_last_run >= t->interval_usec) {
+			uint32_t start = cpu_timer_now();
+			jitter_record(&t->jitter, start - tick_stamp);
+			trace_record(TRACE_TASK_BEGIN, t->id);
+			t->callback(t->callback_arg);
+			trace_record(TRACE_TASK_END, t->id);
+			_stats_update(&t->stats, cpu_timer_now() - start);
+
+			t->last_run_usec = elapsed_usec;
+		}
+	}
+
+	// Real-time tier alone used up the whole time slice
+	if (cpu_timer_now() - tier_start > SYS_TICK_BUDGET_TICKS) {
+		total_overruns++;
+	}
+}
+
 void scheduler_timer_isr(void *userParam, uint8_t TmrCtrNumber)
 {
+	tick_stamp = cpu_timer_now();
+	trace_record(TRACE_ISR_ENTER, 0);
+
 	// We should be done running tasks in a time slice before this fires,
 	// so if tasks are still running, we consumed too many cycles per slice
 	if (tasks_running) {
-		printf("ERROR: OVERRUN SCHEDULER TIME QUANTUM!\n");
-		io_led_color_t color;
-		color.r = 255;
-	    color.g = 0;
-	    color.b = 0;
-		io_led_set(&color);
-		HANG;
+		total_overruns++;
+
+		if (running_task != NULL) {
+			running_task->stats.num_overruns++;
+		}
+
+		// Count every tick, so a task that never returns still
+		// reaches the fault; the slice only clears the count if
+		// it finished without any overrun
+		overrun_in_slice = true;
+		consecutive_overruns++;
+
+		if (consecutive_overruns >= SCHED_OVERRUN_MAX_CONSECUTIVE) {
+			_latch_overrun_fault();
+		}
+
+		// Defer non-critical tasks so critical ones can catch up
+		shed_ticks = SCHED_OVERRUN_SHED_TICKS;
 	}
 
 	elapsed_usec += SYS_TICK_USEC;
+	elapsed_ticks++;
 	scheduler_idle = false;
+
+	// Run real-time tier, letting higher priority
+	// interrupts preempt it
+	Xil_EnableNestedInterrupts();
+	_run_rt_tasks();
+	Xil_DisableNestedInterrupts();
+
+	trace_record(TRACE_ISR_EXIT, 0);
 }
 
 uint64_t scheduler_get_elapsed_usec(void)
 {
-	return elapsed_usec;
+	// 64-bit reads are two loads on the Cortex-A9, so
+	// re-read if the SysTick ISR updated it in between
+	uint64_t a;
+	uint64_t b;
+
+	do {
+		a = elapsed_usec;
+		b = elapsed_usec;
+	} while (a != b);
+
+	return a;
 }
 
 void scheduler_init(void)
@@ -50,6 +187,29 @@ void scheduler_init(void)
 	// Start system timer for periodic interrupts
 	timer_init(scheduler_timer_isr, SYS_TICK_USEC);
 	printf("SCHED:\tTasks per second: %d\n", SYS_TICK_FREQ);
+
+	// Register command
+	cmd_sched_register();
+}
+
+static void _stats_reset(task_stats_t *stats)
+{
+	stats->num_samples = 0;
+	stats->last_ticks = 0;
+	stats->min_ticks = UINT32_MAX;
+	stats->max_ticks = 0;
+	stats->total_ticks = 0;
+	stats->num_overruns = 0;
+}
+
+static void _stats_update(task_stats_t *stats, uint32_t ticks)
+{
+	stats->num_samples++;
+	stats->last_ticks = ticks;
+	stats->total_ticks += ticks;
+
+	if (ticks < stats->min_ticks) stats->min_ticks = ticks;
+	if (ticks > stats->max_ticks) stats->max_ticks = ticks;
 }
 
 void scheduler_tcb_init(task_control_block_t *tcb, task_callback_t callback,
@@ -58,31 +218,46 @@ void scheduler_tcb_init(task_control_block_t *tcb, task_callback_t callback,
 {
 	tcb->id = next_tcb_id++;
 	tcb->name = name;
+	trace_name(TRACE_TASK_BEGIN, tcb->id, name);
 	tcb->callback = callback;
 	tcb->callback_arg = callback_arg;
 	tcb->interval_usec = interval_usec;
 	tcb->last_run_usec = 0;
+	tcb->criticality = TASK_CRITICAL;
+	tcb->realtime = 0;
+	tcb->events = 0;
+	tcb->num_deps = 0;
+
+	_stats_reset(&tcb->stats);
+	jitter_reset(&tcb->jitter);
 }
 
-void scheduler_tcb_register(task_control_block_t *tcb)
+void scheduler_tcb_set_criticality(task_control_block_t *tcb, task_criticality_e criticality)
 {
-	// Don't let clients re-register their tcb
-	if (tcb->registered) {
+	tcb->criticality = criticality;
+}
+
+void scheduler_tcb_depends_on(task_control_block_t *consumer, task_control_block_t *producer)
+{
+	if (consumer->num_deps >= SCHED_TASK_MAX_DEPS || consumer == producer) {
 		HANG;
 	}
 
-	// Mark as registered
-	tcb->registered = 1;
+	consumer->deps[consumer->num_deps++] = producer;
+	order_dirty = true;
+}
 
+static void _list_append(task_control_block_t **head, task_control_block_t *tcb)
+{
 	// Base case: there are no tasks in linked list
-	if (tasks == NULL) {
-		tasks = tcb;
-		tasks->next = NULL;
+	if (*head == NULL) {
+		*head = tcb;
+		tcb->next = NULL;
 		return;
 	}
 
 	// Find end of list
-	task_control_block_t *curr = tasks;
+	task_control_block_t *curr = *head;
 	while (curr->next != NULL) curr = curr->next;
 
 	// Append new tcb to end of list
@@ -90,31 +265,23 @@ void scheduler_tcb_register(task_control_block_t *tcb)
 	tcb->next = NULL;
 }
 
-void scheduler_tcb_unregister(task_control_block_t *tcb)
+static void _list_remove(task_control_block_t **head, task_control_block_t *tcb)
 {
-	// Don't let clients unregister their already unregistered tcb
-	if (!tcb->registered) {
-		HANG;
-	}
-
-	// Mark as unregistered
-	tcb->registered = 0;
-
 	// Make sure list isn't empty
-	if (tasks == NULL) {
+	if (*head == NULL) {
 		HANG;
 	}
 
 	// Special case: trying to remove the head of the list
-	if (tasks->id == tcb->id) {
-		tasks = tasks->next;
+	if ((*head)->id == tcb->id) {
+		*head = (*head)->next;
 		return;
 	}
 
 	// Now we know that 'tcb' to remove is NOT first node
 
 	task_control_block_t *prev = NULL;
-	task_control_block_t *curr = tasks;
+	task_control_block_t *curr = *head;
 
 	// Find spot in linked list to remove tcb
 	while (curr->id != tcb->id) {
@@ -127,39 +294,531 @@ void scheduler_tcb_unregister(task_control_block_t *tcb)
 	prev->next = curr->next;
 }
 
+void scheduler_tcb_register(task_control_block_t *tcb)
+{
+	// Don't let clients re-register their tcb
+	if (tcb->registered) {
+		HANG;
+	}
+
+	// Mark as registered
+	tcb->registered = 1;
+	table_dirty = true;
+
+	_list_append(&tasks, tcb);
+	order_dirty = true;
+}
+
+void scheduler_tcb_register_rt(task_control_block_t *tcb)
+{
+	// Don't let clients re-register their tcb
+	if (tcb->registered) {
+		HANG;
+	}
+
+	// Find a free slot in the real-time tier
+	int i = 0;
+	while (i < SCHED_RT_MAX_TASKS && rt_tasks[i] != NULL) i++;
+	if (i >= SCHED_RT_MAX_TASKS) {
+		HANG;
+	}
+
+	// Mark as registered
+	tcb->registered = 1;
+	tcb->realtime = 1;
+	tcb->next = NULL;
+
+	// ISR picks up the task once the slot is written
+	rt_tasks[i] = tcb;
+}
+
+void scheduler_tcb_register_event(task_control_block_t *tcb, event_t events)
+{
+	// Don't let clients re-register their tcb, and
+	// make sure something can actually trigger it
+	if (tcb->registered || events == 0) {
+		HANG;
+	}
+
+	// Mark as registered
+	tcb->registered = 1;
+	tcb->events = events;
+
+	_list_append(&event_tasks, tcb);
+}
+
+static void _unregister_rt(task_control_block_t *tcb)
+{
+	for (int i = 0; i < SCHED_RT_MAX_TASKS; i++) {
+		if (rt_tasks[i] == tcb) {
+			rt_tasks[i] = NULL;
+			tcb->realtime = 0;
+			return;
+		}
+	}
+
+	// Not in the real-time tier, even though it was marked as such
+	HANG;
+}
+
+void scheduler_tcb_unregister(task_control_block_t *tcb)
+{
+	// Don't let clients unregister their already unregistered tcb
+	if (!tcb->registered) {
+		HANG;
+	}
+
+	// Mark as unregistered
+	tcb->registered = 0;
+
+	if (tcb->realtime) {
+		_unregister_rt(tcb);
+		return;
+	}
+
+	if (tcb->events != 0) {
+		_list_remove(&event_tasks, tcb);
+		tcb->events = 0;
+		return;
+	}
+
+	table_dirty = true;
+
+	_list_remove(&tasks, tcb);
+}
+
 uint8_t scheduler_tcb_is_registered(task_control_block_t *tcb) {
 	return tcb->registered;
 }
 
+void scheduler_set_mode(sched_mode_e new_mode)
+{
+	mode = new_mode;
+	table_dirty = true;
+}
+
+sched_mode_e scheduler_get_mode(void)
+{
+	return mode;
+}
+
+static bool _in_list(task_control_block_t *list, task_control_block_t *tcb)
+{
+	for (task_control_block_t *t = list; t != NULL; t = t->next) {
+		if (t == tcb) return true;
+	}
+
+	return false;
+}
+
+// Stable topological sort: repeatedly moves the first task whose
+// producers have all been moved to the end of the new list, so
+// unrelated tasks keep their registration order
+static void _sort_tasks(void)
+{
+	task_control_block_t *sorted = NULL;
+	task_control_block_t *remaining = tasks;
+
+	while (remaining != NULL) {
+		task_control_block_t *prev = NULL;
+		task_control_block_t *t = remaining;
+
+		while (t != NULL) {
+			bool ready = true;
+			for (int i = 0; i < t->num_deps; i++) {
+				if (_in_list(remaining, t->deps[i])) {
+					ready = false;
+					break;
+				}
+			}
+
+			if (ready) break;
+
+			prev = t;
+			t = t->next;
+		}
+
+		if (t == NULL) {
+			// Every remaining task waits on another one
+			printf("SCHED:\tTask dependency cycle, keeping registration order\n");
+			prev = NULL;
+			t = remaining;
+		}
+
+		// Move 't' from remaining to the end of sorted
+		if (prev == NULL) {
+			remaining = t->next;
+		} else {
+			prev->next = t->next;
+		}
+		_list_append(&sorted, t);
+	}
+
+	tasks = sorted;
+}
+
+// True if one of the task's producers runs at least as often as
+// it does but has not run in this time slice yet
+static bool _waiting_on_deps(task_control_block_t *t)
+{
+	for (int i = 0; i < t->num_deps; i++) {
+		task_control_block_t *p = t->deps[i];
+
+		if (!p->registered || p->events != 0) continue;
+		if (p->interval_usec > t->interval_usec) continue;
+
+		if (p->last_run_usec != elapsed_usec) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static inline void _run_task(task_control_block_t *t, uint32_t slice_tick_stamp)
+{
+	running_task = t;
+	uint32_t start = cpu_timer_now();
+	jitter_record(&t->jitter, start - slice_tick_stamp);
+	trace_record(TRACE_TASK_BEGIN, t->id);
+	t->callback(t->callback_arg);
+	trace_record(TRACE_TASK_END, t->id);
+	_stats_update(&t->stats, cpu_timer_now() - start);
+	running_task = NULL;
+
+	t->last_run_usec = elapsed_usec;
+}
+
+static void _run_list(bool shedding, uint32_t slice_tick_stamp)
+{
+	task_control_block_t *t = tasks;
+	while (t != NULL) {
+		uint64_t usec_since_last_run = elapsed_usec - t->last_run_usec;
+
+		if (shedding && t->criticality != TASK_CRITICAL) {
+			// Deferred: task stays due and runs once shedding ends
+		} else if (usec_since_last_run >= t->interval_usec) {
+			// Stays due until the slice its producers run in
+			if (!_waiting_on_deps(t)) {
+				// Time to run this task!
+				_run_task(t, slice_tick_stamp);
+			}
+		}
+
+		// Go to next task in linked list
+		t = t->next;
+	}
+}
+
+static void _run_table(bool shedding, uint32_t slice_tick_stamp)
+{
+	task_control_block_t **slot;
+	uint32_t num_entries;
+	schedule_table_get_slot(elapsed_ticks, &slot, &num_entries);
+
+	for (uint32_t i = 0; i < num_entries; i++) {
+		task_control_block_t *t = slot[i];
+
+		// A task earlier in this slot might have unregistered it
+		if (!t->registered) continue;
+
+		// Shed tasks simply miss their slot
+		if (shedding && t->criticality != TASK_CRITICAL) continue;
+
+		_run_task(t, slice_tick_stamp);
+	}
+}
+
+static void _run_events(event_t signaled, bool shedding, uint32_t slice_tick_stamp)
+{
+	if (signaled == 0) {
+		return;
+	}
+
+	task_control_block_t *t = event_tasks;
+	while (t != NULL) {
+		// Grab next first, the task might unregister itself
+		task_control_block_t *next = t->next;
+
+		if (t->events & signaled) {
+			if (shedding && t->criticality != TASK_CRITICAL) {
+				// Deferred: keep the event pending until shedding ends
+				event_post(t->events & signaled);
+			} else {
+				_run_task(t, slice_tick_stamp);
+			}
+		}
+
+		t = next;
+	}
+}
+
+static void _update_load(void)
+{
+	if (elapsed_ticks - window_start_slice < SCHED_LOAD_WINDOW_SLICES) {
+		return;
+	}
+
+	uint32_t now = cpu_timer_now();
+	uint32_t window_ticks = now - window_start_ticks;
+
+	if (window_ticks > 0) {
+		LOG_sched_cpu_load = 100.0 * (1.0 - (double) window_idle_ticks / (double) window_ticks);
+	}
+
+	window_idle_ticks = 0;
+	window_start_ticks = now;
+	window_start_slice = elapsed_ticks;
+}
+
+// Sleeps until the next SysTick, accounting for idle time
+//
+// IRQs are masked around the check of 'scheduler_idle' and the WFI so a
+// SysTick landing in between can't be missed. Idle time is stamped right
+// after waking, before the pending ISR runs, so ISR time counts as busy.
+static void _idle(uint32_t slice_start)
+{
+	Xil_ExceptionDisable();
+
+	uint32_t idle_start = cpu_timer_now();
+
+	uint32_t busy_ticks = idle_start - slice_start;
+	if (busy_ticks > max_busy_ticks) {
+		max_busy_ticks = busy_ticks;
+	}
+
+	while (scheduler_idle) {
+		WFI();
+		window_idle_ticks += cpu_timer_now() - idle_start;
+
+		// Let the pending interrupt run
+		Xil_ExceptionEnable();
+		Xil_ExceptionDisable();
+
+		idle_start = cpu_timer_now();
+	}
+
+	Xil_ExceptionEnable();
+
+	_update_load();
+}
+
+double scheduler_get_cpu_load(void)
+{
+	return LOG_sched_cpu_load;
+}
+
+double scheduler_get_max_busy_usec(void)
+{
+	return cpu_timer_ticks_to_usec(max_busy_ticks);
+}
+
 void scheduler_run(void)
 {
 	printf("SCHED:\tRunning scheduler...\n");
 
+	window_start_ticks = cpu_timer_now();
+	window_start_slice = elapsed_ticks;
+
 	// This is the main event loop that runs the device
 	while (1) {
+		uint32_t slice_start = cpu_timer_now();
+
+		// Latch now: if this slice overruns, the next
+		// SysTick updates 'tick_stamp' while tasks still run
+		uint32_t slice_tick_stamp = tick_stamp;
+
+		// Cleared by SysTick; if it fires while tasks are
+		// still running, the next time slice starts right away
+		scheduler_idle = true;
+
+		overrun_in_slice = false;
 		tasks_running = true;
 
-		task_control_block_t *t = tasks;
-		while (t != NULL) {
-			uint64_t usec_since_last_run = elapsed_usec - t->last_run_usec;
+		// Shed non-critical tasks after a recent overrun. SysTick
+		// reloads the count on an overrun, which must not be lost
+		// between the read and the write here
+		Xil_ExceptionDisable();
+		bool shedding = (shed_ticks > 0);
+		if (shedding) {
+			shed_ticks--;
+		}
+		Xil_ExceptionEnable();
 
-			if (usec_since_last_run >= t->interval_usec) {
-				// Time to run this task!
-				running_task = t;
-				t->callback(t->callback_arg);
-				running_task = NULL;
+		// Events posted from here on trigger tasks in the next slice
+		event_t signaled = event_take();
 
-				t->last_run_usec = elapsed_usec;
+		// Software timers due in this slice go first
+		timers_run(elapsed_ticks);
+
+		if (order_dirty) {
+			order_dirty = false;
+			table_dirty = true;
+			_sort_tasks();
+		}
+
+		if (mode == SCHED_MODE_TABLE && table_dirty) {
+			table_dirty = false;
+
+			if (schedule_table_build(tasks) != SUCCESS) {
+				// Hyperperiod too long, so walk the list instead
+				printf("SCHED:\tSchedule table too large, using list mode\n");
+				mode = SCHED_MODE_LIST;
 			}
+		}
 
-			// Go to next task in linked list
-			t = t->next;
+		if (mode == SCHED_MODE_TABLE) {
+			_run_table(shedding, slice_tick_stamp);
+		} else {
+			_run_list(shedding, slice_tick_stamp);
+		}
+
+		_run_events(signaled, shedding, slice_tick_stamp);
+
+		// Spend the slack left in this slice on background jobs
+		if (!shedding) {
+			job_run(slice_tick_stamp, JOB_BUDGET_TICKS);
 		}
 
 		tasks_running = false;
 
+		// Finished this time slice on time
+		if (!overrun_in_slice) {
+			consecutive_overruns = 0;
+		}
+
 		// Wait here until unpaused (i.e. when SysTick fires)
-		scheduler_idle = true;
-		while (scheduler_idle);
+		_idle(slice_start);
 	}
 }
+
+void scheduler_stats_reset(void)
+{
+	task_control_block_t *lists[] = { tasks, event_tasks };
+	for (int i = 0; i < 2; i++) {
+		task_control_block_t *t = lists[i];
+		while (t != NULL) {
+			_stats_reset(&t->stats);
+			jitter_reset(&t->jitter);
+			t = t->next;
+		}
+	}
+
+	for (int i = 0; i < SCHED_RT_MAX_TASKS; i++) {
+		if (rt_tasks[i] != NULL) {
+			_stats_reset(&rt_tasks[i]->stats);
+			jitter_reset(&rt_tasks[i]->jitter);
+		}
+	}
+
+	total_overruns = 0;
+	max_busy_ticks = 0;
+}
+
+static void _stats_print_task(task_control_block_t *t)
+{
+	task_stats_t *s = &t->stats;
+
+	// Real-time tier tasks are marked with a '*',
+	// event-driven tasks with a '+'
+	const char *tier = t->realtime ? "*" : (t->events != 0 ? "+" : "");
+
+	if (s->num_samples == 0) {
+		debug_printf("%s%-16s0\r\n", tier, t->name);
+		return;
+	}
+
+	uint32_t mean_ticks = (uint32_t) (s->total_ticks / s->num_samples);
+
+	// Percent of one time slice used in the worst case
+	double max_load = 100.0 * (double) s->max_ticks / (double) SYS_TICK_BUDGET_TICKS;
+
+	// Percent of all time slices used on average, accounting
+	// for the task only running every 'interval_usec'
+	double avg_load = 100.0 * (double) mean_ticks / (double) SYS_TICK_BUDGET_TICKS;
+	if (t->interval_usec > SYS_TICK_USEC) {
+		avg_load *= (double) SYS_TICK_USEC / (double) t->interval_usec;
+	}
+
+	debug_printf("%s%-16s%lu\t%.2f\t%.2f\t%.2f\t%.2f\t\t%.1f\t%.1f\t%lu\r\n",
+			tier, t->name, s->num_samples,
+			cpu_timer_ticks_to_usec(s->last_ticks),
+			cpu_timer_ticks_to_usec(s->min_ticks),
+			cpu_timer_ticks_to_usec(mean_ticks),
+			cpu_timer_ticks_to_usec(s->max_ticks),
+			max_load, avg_load, s->num_overruns);
+}
+
+void scheduler_stats_print(void)
+{
+	debug_printf("Budget per tick: %d usec\r\n", SYS_TICK_USEC);
+	debug_printf("Overruns: %lu\r\n", total_overruns);
+	debug_printf("CPU load: %.1f%%, max busy per tick: %.2f usec\r\n",
+			scheduler_get_cpu_load(), scheduler_get_max_busy_usec());
+
+	if (mode == SCHED_MODE_TABLE) {
+		debug_printf("Schedule table: %lu slots, max %lu tasks per slot\r\n",
+				schedule_table_get_num_slots(), schedule_table_get_max_slot_size());
+	}
+
+	debug_printf("name\t\truns\tlast\tmin\tmean\tmax (usec)\tmax %%\tavg %%\tovr\r\n");
+
+	for (int i = 0; i < SCHED_RT_MAX_TASKS; i++) {
+		if (rt_tasks[i] != NULL) {
+			_stats_print_task(rt_tasks[i]);
+		}
+	}
+
+	task_control_block_t *t = tasks;
+	while (t != NULL) {
+		_stats_print_task(t);
+		t = t->next;
+	}
+
+	t = event_tasks;
+	while (t != NULL) {
+		_stats_print_task(t);
+		t = t->next;
+	}
+}
+
+task_control_block_t *scheduler_find_task(const char *name)
+{
+	for (int i = 0; i < SCHED_RT_MAX_TASKS; i++) {
+		task_control_block_t *t = rt_tasks[i];
+		if (t != NULL && strcmp(t->name, name) == 0) {
+			return t;
+		}
+	}
+
+	task_control_block_t *lists[] = { tasks, event_tasks };
+	for (int i = 0; i < 2; i++) {
+		task_control_block_t *t = lists[i];
+		while (t != NULL) {
+			if (strcmp(t->name, name) == 0) {
+				return t;
+			}
+
+			t = t->next;
+		}
+	}
+
+	return NULL;
+}
+
+void scheduler_jitter_print(task_control_block_t *tcb)
+{
+	jitter_hist_t *h = &tcb->jitter;
+
+	debug_printf("Start latency of '%s' (%lu runs):\r\n", tcb->name, h->num_samples);
+
+	if (h->num_samples == 0) {
+		return;
+	}
+
+	debug_printf("p50:\t%.3f usec\r\n", cpu_timer_ticks_to_usec(jitter_percentile(h, 50.0)));
+	debug_printf("p90:\t%.3f usec\r\n", cpu_timer_ticks_to_usec(jitter_percentile(h, 90.0)));
+	debug_printf("p99:\t%.3f usec\r\n", cpu_timer_ticks_to_usec(jitter_percentile(h, 99.0)));
+	debug_printf("p99.9:\t%.3f usec\r\n", cpu_timer_ticks_to_usec(jitter_percentile(h, 99.9)));
+	debug_printf("max:\t%.3f usec\r\n", cpu_timer_ticks_to_usec(h->max_ticks));
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 
 #include "../sys/defines.h"
+#include "../sys/event.h"
+#include "../sys/jitter.h"
 
 
 // SysTick
@@ -17,11 +19,95 @@
 #define SYS_TICK_FREQ	(10000) // Hz
 #define SYS_TICK_USEC	(SEC_TO_USEC(1) / SYS_TICK_FREQ)
 
+// Overrun policy
+//
+// If the tasks are still running when the SysTick fires, the time quantum
+// was overrun. Non-critical tasks are then skipped (deferred) for the next
+// SCHED_OVERRUN_SHED_TICKS time slices so the critical tasks can catch up.
+//
+// A fault is latched (red LED, HANG) only once SCHED_OVERRUN_MAX_CONSECUTIVE
+// SysTicks in a row fired while tasks were still running, whether over many
+// overrun slices or one slice that never finishes. Set this to 1 to hang on
+// the first overrun.
+//
+#define SCHED_OVERRUN_SHED_TICKS		(10)
+#define SCHED_OVERRUN_MAX_CONSECUTIVE	(10)
+
+// Real-time tier
+//
+// Tasks registered with scheduler_tcb_register_rt() run directly from the
+// SysTick interrupt with nested interrupts enabled, so they preempt the
+// cooperative (background) tier and always start right after the tick.
+// Keep them short: they must not print or touch state owned by the
+// background tier without care.
+//
+#define SCHED_RT_MAX_TASKS				(8)
+
+// Event-driven tasks
+//
+// Tasks registered with scheduler_tcb_register_event() have no interval.
+// They run once in the time slice after any of their events was posted
+// (see event.h), after the periodic tasks of that slice.
+//
+
+// Task dependencies
+//
+// A task can depend on up to SCHED_TASK_MAX_DEPS producer tasks, see
+// scheduler_tcb_depends_on(). In a time slice where both are due, the
+// producer runs first, no matter which was registered first. A consumer
+// whose interval is a multiple of its producer's also stays phase aligned
+// to it: it only runs in time slices where the producer ran.
+//
+#define SCHED_TASK_MAX_DEPS				(4)
+
+// CPU load is averaged over this many time slices (100 ms)
+#define SCHED_LOAD_WINDOW_SLICES		(SYS_TICK_FREQ / 10)
+
+//
+// How the scheduler finds which tasks are due each time slice:
+//
+// SCHED_MODE_LIST  -- walk all registered tasks and compare elapsed time
+// SCHED_MODE_TABLE -- look up the precomputed cyclic schedule table
+//                     (see schedule_table.h); falls back to list mode
+//                     if the table does not fit
+//
+typedef enum sched_mode_e {
+	SCHED_MODE_LIST = 1,
+	SCHED_MODE_TABLE
+} sched_mode_e;
+
 //
 // Callback into application when task is run:
 //
 typedef void (*task_callback_t)(void *);
 
+//
+// Criticality of each task
+//
+// Non-critical tasks (serial output, command processing, etc)
+// are shed by the scheduler after a time quantum overrun.
+//
+typedef enum task_criticality_e {
+	TASK_CRITICAL = 1,
+	TASK_NON_CRITICAL
+} task_criticality_e;
+
+//
+// Execution time statistics of each task,
+// measured in CPU timer ticks (see drv/cpu_timer.h)
+//
+typedef struct task_stats_t {
+	uint32_t num_samples;
+	uint32_t last_ticks;
+	uint32_t min_ticks;
+	uint32_t max_ticks;
+	uint64_t total_ticks;
+
+	// Number of time quantum overruns
+	// which happened while this task was running
+	uint32_t num_overruns;
+} task_stats_t;
+
 //
 // TCB of each task
 //
@@ -29,10 +115,25 @@ typedef struct task_control_block_t {
 	int id;
 	const char *name;
 	uint8_t registered;
+	uint8_t realtime;
+
+	// Events which trigger this task, 0 for periodic tasks
+	event_t events;
+
+	// Tasks which must run before this one, see scheduler_tcb_depends_on()
+	struct task_control_block_t *deps[SCHED_TASK_MAX_DEPS];
+	uint8_t num_deps;
+
+	task_criticality_e criticality;
 	task_callback_t callback;
 	void *callback_arg;
 	uint64_t interval_usec;
 	uint64_t last_run_usec;
+	task_stats_t stats;
+
+	// Start latency of each run, relative to the SysTick
+	// interrupt which started the time slice
+	jitter_hist_t jitter;
 	struct task_control_block_t *next;
 } task_control_block_t;
 
@@ -40,12 +141,28 @@ typedef struct task_control_block_t {
 void scheduler_init(void);
 void scheduler_run(void);
 
+void scheduler_set_mode(sched_mode_e mode);
+sched_mode_e scheduler_get_mode(void);
+
 void scheduler_tcb_init(task_control_block_t *tcb, task_callback_t callback,
 		void *callback_arg, const char *name, uint32_t interval_usec);
+void scheduler_tcb_set_criticality(task_control_block_t *tcb, task_criticality_e criticality);
+void scheduler_tcb_depends_on(task_control_block_t *consumer, task_control_block_t *producer);
 void scheduler_tcb_register(task_control_block_t *tcb);
+void scheduler_tcb_register_rt(task_control_block_t *tcb);
+void scheduler_tcb_register_event(task_control_block_t *tcb, event_t events);
 void scheduler_tcb_unregister(task_control_block_t *tcb);
 uint8_t scheduler_tcb_is_registered(task_control_block_t *tcb);
 
 uint64_t scheduler_get_elapsed_usec(void);
 
+double scheduler_get_cpu_load(void);
+double scheduler_get_max_busy_usec(void);
+
+task_control_block_t *scheduler_find_task(const char *name);
+
+void scheduler_stats_reset(void);
+void scheduler_stats_print(void);
+void scheduler_jitter_print(task_control_block_t *tcb);
+
 #endif // SCHEDULER_H
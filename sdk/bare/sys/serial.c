@@ -1,4 +1,5 @@
 #include "serial.h"
+#include "event.h"
 #include "scheduler.h"
 #include "../drv/uart.h"
 #include <string.h>
@@ -19,11 +20,16 @@ static int print_amount = 0;
 
 static task_control_block_t tcb;
 
+// Posted while there is output waiting to be sent
+static event_t tx_event;
+
 void serial_init(void)
 {
 	printf("DB:\tInitializing serial task...\n");
-	scheduler_tcb_init(&tcb, serial_callback, NULL, "serial", SERIAL_INTERVAL_USEC);
-	scheduler_tcb_register(&tcb);
+	tx_event = event_create();
+	scheduler_tcb_init(&tcb, serial_callback, NULL, "serial", 0);
+	scheduler_tcb_set_criticality(&tcb, TASK_NON_CRITICAL);
+	scheduler_tcb_register_event(&tcb, tx_event);
 }
 
 void serial_callback(void *arg)
@@ -47,6 +53,9 @@ void serial_callback(void *arg)
 		// Check if done outputting data
 		if (print_amount == 0) {
 			print_idx = -1;
+		} else {
+			// Send the rest next time slice
+			event_post(tx_event);
 		}
 	}
 }
@@ -75,4 +84,16 @@ void serial_write(char *msg, int len)
 	for (int i = 0; i < len; i++) {
 		_append_to_output_buffer(msg[i]);
 	}
+
+	event_post(tx_event);
+}
+
+int serial_get_free_space(void)
+{
+	return OUTPUT_BUFFER_LENGTH - print_amount;
+}
+
+int serial_get_pending(void)
+{
+	return print_amount;
 }
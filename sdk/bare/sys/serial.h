@@ -3,12 +3,16 @@
 
 #include "../sys/defines.h"
 
-#define SERIAL_UPDATES_PER_SEC		(10000)
-#define SERIAL_INTERVAL_USEC		(USEC_IN_SEC / SERIAL_UPDATES_PER_SEC)
-
 void serial_init(void);
 void serial_callback(void *arg);
 
 void serial_write(char *msg, int len);
 
+// Number of chars which can be written without
+// overwriting output that has not been sent yet
+int serial_get_free_space(void);
+
+// Number of chars written but not yet sent to the UART
+int serial_get_pending(void);
+
 #endif // SERIAL_H
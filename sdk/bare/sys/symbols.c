@@ -0,0 +1,60 @@
+#include "symbols.h"
+#include "defines.h"
+#include "cmd/cmd_sym.h"
+#include <stdio.h>
+#include <string.h>
+
+// Defined by the linker script (lscript.ld, or sim_symbols.ld on the host)
+extern const symbol_t __symbols_start[];
+extern const symbol_t __symbols_end[];
+
+void symbols_init(void)
+{
+	printf("DB:\tInitializing symbol registry...\n");
+
+	// The binary search relies on the linker's sort, and two
+	// exports of the same name would make lookups ambiguous
+	for (int i = 1; i < symbols_count(); i++) {
+		if (strcmp(__symbols_start[i - 1].name, __symbols_start[i].name) >= 0) {
+			printf("DB:\tSymbol '%s' out of order or exported twice\n", __symbols_start[i].name);
+			HANG;
+		}
+	}
+
+	cmd_sym_register();
+}
+
+const symbol_t *symbol_find(const char *name)
+{
+	int lo = 0;
+	int hi = symbols_count() - 1;
+
+	while (lo <= hi) {
+		int mid = lo + (hi - lo) / 2;
+		int c = strcmp(name, __symbols_start[mid].name);
+
+		if (c == 0) {
+			return &__symbols_start[mid];
+		} else if (c < 0) {
+			hi = mid - 1;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	return NULL;
+}
+
+int symbols_count(void)
+{
+	return __symbols_end - __symbols_start;
+}
+
+const symbol_t *symbol_get(int i)
+{
+	if (i < 0 || i >= symbols_count()) {
+		return NULL;
+	}
+
+	return &__symbols_start[i];
+}
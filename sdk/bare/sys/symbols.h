@@ -0,0 +1,45 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <stdint.h>
+#include "log.h"
+
+// Symbol registry
+//
+// Lets commands refer to global variables by name instead of by
+// address, e.g. 'log reg 0 Id LOG_Id 40000'. Apps publish variables
+// next to their definition:
+//
+//   double LOG_Id = 0.0;
+//   SYMBOL_EXPORT(LOG_Id, DOUBLE);
+//
+// Each export is a constant symbol_t placed in its own '.symbols.<name>'
+// section. The linker script gathers them with SORT_BY_NAME into one
+// table, sorted by name, between __symbols_start and __symbols_end, so
+// lookups are a binary search and nothing is built at run time. The
+// alignment is pinned so the compiler can't pad entries apart.
+//
+// Names are resolved once, when a command runs; the resolved address
+// is then used exactly like one typed in by hand.
+//
+typedef struct symbol_t {
+	const char *name;
+	void *addr;
+	var_type_e type;
+} symbol_t;
+
+#define SYMBOL_EXPORT(var, var_type) \
+	static const symbol_t _symbol_##var \
+	__attribute__((used, section(".symbols." #var), aligned(__alignof__(symbol_t)))) = { \
+		#var, (void *) &(var), (var_type) \
+	}
+
+void symbols_init(void);
+
+// Returns NULL if no variable was exported as 'name'
+const symbol_t *symbol_find(const char *name);
+
+int symbols_count(void);
+const symbol_t *symbol_get(int i);
+
+#endif // SYMBOLS_H
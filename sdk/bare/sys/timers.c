@@ -0,0 +1,208 @@
+#include "timers.h"
+#include "defines.h"
+#include "scheduler.h"
+#include <stdbool.h>
+
+#define TIMER_WHEEL_MASK		(TIMER_WHEEL_SLOTS - 1)
+#define TIMER_POOL_WORDS		(TIMER_POOL_SIZE / 32)
+
+// IDs are (generation << 8) | pool index
+#define TIMER_ID(idx, gen)		((int) (((gen) << 8) | (idx)))
+#define TIMER_ID_IDX(id)		((id) & 0xFF)
+#define TIMER_ID_GEN(id)		(((id) >> 8) & 0xFFFF)
+
+// Tag holds the generation and the cancelled flag in one
+// word, so cancelling can't hit a timer which was reused
+#define TAG(gen, cancelled)		(((uint32_t) (gen) << 1) | (cancelled))
+#define TAG_GEN(tag)			(((tag) >> 1) & 0xFFFF)
+#define TAG_CANCELLED(tag)		((tag) & 1)
+
+typedef struct timer_entry_t {
+	timer_callback_t callback;
+	void *arg;
+
+	// 0 for one-shot timers
+	uint32_t period_ticks;
+
+	// Delay while pending, absolute SysTick once in the wheel
+	uint32_t expiry;
+
+	volatile uint32_t tag;
+	struct timer_entry_t *next;
+} timer_entry_t;
+
+static timer_entry_t pool[TIMER_POOL_SIZE];
+
+// Bit set for each pool entry in use
+static volatile uint32_t used[TIMER_POOL_WORDS];
+
+// New timers are pushed here from any context, and moved
+// into the wheel by timers_run() -- the only code which
+// touches the wheel itself
+static timer_entry_t *volatile pending = NULL;
+
+static timer_entry_t *wheel[TIMER_WHEEL_SLOTS];
+
+// Last SysTick processed
+static uint32_t wheel_tick = 0;
+
+static int _alloc(void)
+{
+	for (int w = 0; w < TIMER_POOL_WORDS; w++) {
+		uint32_t old = used[w];
+
+		while (old != UINT32_MAX) {
+			int bit = __builtin_ctz(~old);
+			if (__atomic_compare_exchange_n(&used[w], &old, old | (1U << bit),
+					false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+				return w * 32 + bit;
+			}
+
+			// 'old' was reloaded by the failed exchange, try again
+		}
+	}
+
+	return FAILURE;
+}
+
+static void _free(timer_entry_t *e)
+{
+	int idx = e - pool;
+
+	// Bump generation, so stale IDs no longer match
+	e->tag = TAG(TAG_GEN(e->tag) + 1, 0);
+
+	__atomic_fetch_and(&used[idx / 32], ~(1U << (idx % 32)), __ATOMIC_RELEASE);
+}
+
+static inline uint32_t _usec_to_ticks(uint32_t usec)
+{
+	return MAX((usec + SYS_TICK_USEC - 1) / SYS_TICK_USEC, 1);
+}
+
+static int _start(uint32_t delay_ticks, uint32_t period_ticks, timer_callback_t callback, void *arg)
+{
+	int idx = _alloc();
+	if (idx < 0) {
+		return FAILURE;
+	}
+
+	timer_entry_t *e = &pool[idx];
+	e->callback = callback;
+	e->arg = arg;
+	e->period_ticks = period_ticks;
+	e->expiry = delay_ticks;
+
+	int id = TIMER_ID(idx, TAG_GEN(e->tag));
+
+	// Push onto pending list
+	timer_entry_t *old = pending;
+	do {
+		e->next = old;
+	} while (!__atomic_compare_exchange_n(&pending, &old, e,
+			false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	return id;
+}
+
+int timer_after(uint32_t usec, timer_callback_t callback, void *arg)
+{
+	return _start(_usec_to_ticks(usec), 0, callback, arg);
+}
+
+int timer_every(uint32_t usec, timer_callback_t callback, void *arg)
+{
+	uint32_t ticks = _usec_to_ticks(usec);
+	return _start(ticks, ticks, callback, arg);
+}
+
+int timer_cancel(int id)
+{
+	if (id < 0 || TIMER_ID_IDX(id) >= TIMER_POOL_SIZE) {
+		return FAILURE;
+	}
+
+	timer_entry_t *e = &pool[TIMER_ID_IDX(id)];
+
+	// Only succeeds if the entry still belongs to this timer. The
+	// entry is freed once timers_run() comes across it.
+	uint32_t expected = TAG(TIMER_ID_GEN(id), 0);
+	if (!__atomic_compare_exchange_n(&e->tag, &expected, TAG(TIMER_ID_GEN(id), 1),
+			false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+static inline void _wheel_insert(timer_entry_t *e)
+{
+	timer_entry_t **slot = &wheel[e->expiry & TIMER_WHEEL_MASK];
+	e->next = *slot;
+	*slot = e;
+}
+
+static void _drain_pending(uint32_t tick)
+{
+	timer_entry_t *list = __atomic_exchange_n(&pending, NULL, __ATOMIC_ACQUIRE);
+
+	// Reverse, so timers started in the same tick fire in order
+	timer_entry_t *reversed = NULL;
+	while (list != NULL) {
+		timer_entry_t *next = list->next;
+		list->next = reversed;
+		reversed = list;
+		list = next;
+	}
+
+	while (reversed != NULL) {
+		timer_entry_t *e = reversed;
+		reversed = e->next;
+
+		// Delay counts from the next tick, so it never fires early
+		e->expiry += tick;
+		_wheel_insert(e);
+	}
+}
+
+static void _process_slot(uint32_t tick)
+{
+	timer_entry_t **link = &wheel[tick & TIMER_WHEEL_MASK];
+
+	while (*link != NULL) {
+		timer_entry_t *e = *link;
+
+		if (TAG_CANCELLED(e->tag)) {
+			*link = e->next;
+			_free(e);
+			continue;
+		}
+
+		// Hashed into this slot, but expires on a later lap
+		if (e->expiry != tick) {
+			link = &e->next;
+			continue;
+		}
+
+		*link = e->next;
+		e->callback(e->arg);
+
+		if (e->period_ticks > 0 && !TAG_CANCELLED(e->tag)) {
+			e->expiry += e->period_ticks;
+			_wheel_insert(e);
+		} else {
+			_free(e);
+		}
+	}
+}
+
+void timers_run(uint32_t tick)
+{
+	_drain_pending(tick);
+
+	// Catch up on ticks missed during an overrun
+	while (wheel_tick != tick) {
+		wheel_tick++;
+		_process_slot(wheel_tick);
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include <stdint.h>
+
+// Software timers
+//
+// Runs a callback once after a delay, or repeatedly, without needing a
+// task of its own. Callbacks run from the scheduler loop at the start of
+// the time slice they expire in, before the periodic tasks, so they must
+// be short like any task callback.
+//
+// Timers live in a hashed timing wheel with one slot per SysTick, backed
+// by a fixed pool. Starting and cancelling a timer is O(1), lock-free and
+// safe from tasks, timer callbacks and ISRs.
+//
+// Resolution is one SysTick: a timer never fires early, but can fire up
+// to one SysTick late.
+//
+#define TIMER_WHEEL_SLOTS		(256) // must be a power of 2
+#define TIMER_POOL_SIZE			(64)  // must be a multiple of 32, at most 256
+
+typedef void (*timer_callback_t)(void *);
+
+// Both return the ID of the new timer, or FAILURE if the pool is empty
+int timer_after(uint32_t usec, timer_callback_t callback, void *arg);
+int timer_every(uint32_t usec, timer_callback_t callback, void *arg);
+
+// Returns FAILURE if the timer already fired or was cancelled
+int timer_cancel(int id);
+
+// Fires timers which expire up to and including SysTick 'tick';
+// called by the scheduler each time slice
+void timers_run(uint32_t tick);
+
+#endif // TIMERS_H
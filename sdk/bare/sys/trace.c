@@ -0,0 +1,207 @@
+#include "trace.h"
+#include "debug.h"
+#include "defines.h"
+#include "job.h"
+#include "serial.h"
+#include "cmd/cmd_trace.h"
+#include "../drv/cpu_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct trace_name_t {
+	uint16_t event;
+	uint16_t id;
+	const char *name;
+} trace_name_t;
+
+static trace_record_t records[TRACE_NUM_RECORDS];
+
+// Total number of records ever written; slot is 'head' mod TRACE_NUM_RECORDS
+static volatile uint32_t head = 0;
+
+static trace_name_t names[TRACE_MAX_NAMES];
+static int num_names = 0;
+
+static volatile uint8_t trace_running = 0;
+
+
+void trace_init(void)
+{
+	// Start with tracing disabled
+	trace_stop();
+	trace_clear();
+
+	// Register command
+	cmd_trace_register();
+}
+
+void trace_start(void)
+{
+	trace_running = 1;
+}
+
+void trace_stop(void)
+{
+	trace_running = 0;
+}
+
+uint8_t trace_is_running(void)
+{
+	return trace_running;
+}
+
+void trace_clear(void)
+{
+	head = 0;
+}
+
+void trace_record(trace_event_e event, uint16_t id)
+{
+	if (!trace_running) {
+		return;
+	}
+
+	// Claim a slot atomically, so ISRs which preempt
+	// us mid-record get their own slot
+	uint32_t idx = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+
+	trace_record_t *r = &records[idx & (TRACE_NUM_RECORDS - 1)];
+	r->timestamp = cpu_timer_now();
+	r->event = event;
+	r->id = id;
+}
+
+void trace_mark(uint16_t id)
+{
+	trace_record(TRACE_MARKER, id);
+}
+
+void trace_name(trace_event_e event, uint16_t id, const char *name)
+{
+	// Re-use entry if this id was named before
+	for (int i = 0; i < num_names; i++) {
+		if (names[i].event == event && names[i].id == id) {
+			names[i].name = name;
+			return;
+		}
+	}
+
+	// Out of space, so this id shows up unnamed
+	if (num_names >= TRACE_MAX_NAMES) {
+		return;
+	}
+
+	names[num_names].event = event;
+	names[num_names].id = id;
+	names[num_names].name = name;
+	num_names++;
+}
+
+
+
+// ****************
+// Job which streams
+// the trace to the UART
+// ****************
+
+typedef enum sm_states_e {
+	HEADER = 1,
+	NAMES,
+	RECORDS,
+	FOOTER
+} sm_states_e;
+
+typedef struct sm_ctx_t {
+	sm_states_e state;
+	int name_idx;
+	uint32_t first;
+	uint32_t num_bytes;
+	uint32_t bytes_sent;
+	job_t job;
+} sm_ctx_t;
+
+#define MSG_LENGTH			(128)
+
+// Max raw bytes handed to the serial driver per step
+#define DUMP_CHUNK_BYTES	(512)
+
+static job_status_e _dump_step(void *arg)
+{
+	sm_ctx_t *ctx = (sm_ctx_t *) arg;
+
+	// Wait for UART to drain so no output is lost
+	if (serial_get_free_space() < MSG_LENGTH) {
+		return JOB_YIELD;
+	}
+
+	switch (ctx->state) {
+	case HEADER:
+		debug_printf("TRACE BEGIN %lu %lu\r\n", (uint32_t) (ctx->num_bytes / sizeof(trace_record_t)), (uint32_t) CPU_TIMER_TICKS_PER_SEC);
+		ctx->state = NAMES;
+		break;
+
+	case NAMES:
+		if (ctx->name_idx >= num_names) {
+			debug_printf("TRACE RAW %lu\r\n", ctx->num_bytes);
+			ctx->state = RECORDS;
+		} else {
+			trace_name_t *n = &names[ctx->name_idx++];
+			debug_printf("TRACE NAME %d %d %s\r\n", n->event, n->id, n->name);
+		}
+		break;
+
+	case RECORDS:
+	{
+		if (ctx->bytes_sent >= ctx->num_bytes) {
+			ctx->state = FOOTER;
+			break;
+		}
+
+		// Records are contiguous from 'first' to the end of
+		// the buffer, then wrap to the start
+		uint32_t offset = ((ctx->first * sizeof(trace_record_t)) + ctx->bytes_sent) % sizeof(records);
+		uint32_t len = MIN(ctx->num_bytes - ctx->bytes_sent, sizeof(records) - offset);
+		len = MIN(len, DUMP_CHUNK_BYTES);
+		len = MIN(len, (uint32_t) serial_get_free_space());
+
+		serial_write((char *) records + offset, len);
+		ctx->bytes_sent += len;
+		break;
+	}
+
+	case FOOTER:
+		debug_printf("\r\nTRACE END\r\n\r\n");
+		return JOB_DONE;
+
+	default:
+		// Can't happen
+		HANG;
+		break;
+	}
+
+	return JOB_CONTINUE;
+}
+
+static sm_ctx_t ctx;
+
+int trace_dump_uart(void)
+{
+	// Only one dump can run at a time
+	if (job_is_active(&ctx.job)) {
+		return FAILURE;
+	}
+
+	uint32_t total = head;
+	uint32_t count = MIN(total, TRACE_NUM_RECORDS);
+
+	// Initialize the state machine context
+	ctx.state = HEADER;
+	ctx.name_idx = 0;
+	ctx.first = (total - count) & (TRACE_NUM_RECORDS - 1);
+	ctx.num_bytes = count * sizeof(trace_record_t);
+	ctx.bytes_sent = 0;
+
+	// Stream in the slack of each time slice
+	job_init(&ctx.job, _dump_step, &ctx, "tracedump");
+	return job_start(&ctx.job);
+}
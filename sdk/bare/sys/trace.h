@@ -0,0 +1,51 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Event trace recorder
+//
+// Scheduler, ISR and command activity is recorded into a ring buffer of
+// compact binary records, each stamped with the CPU timer (drv/cpu_timer.h).
+// Recording is lock-free and safe from ISRs, so it can stay on without
+// disturbing the timing being observed.
+//
+// The buffer is streamed raw over the UART by 'trace dump' and converted
+// on the host with tools/trace2json.py.
+//
+#define TRACE_NUM_RECORDS		(4096)	// Must be a power of 2
+#define TRACE_MAX_NAMES			(64)
+
+
+typedef enum trace_event_e {
+	TRACE_TASK_BEGIN = 1,
+	TRACE_TASK_END,
+	TRACE_ISR_ENTER,
+	TRACE_ISR_EXIT,
+	TRACE_CMD_BEGIN,
+	TRACE_CMD_END,
+	TRACE_MARKER
+} trace_event_e;
+
+typedef struct trace_record_t {
+	uint32_t timestamp;
+	uint16_t event;
+	uint16_t id;
+} trace_record_t;
+
+void trace_init(void);
+
+void trace_start(void);
+void trace_stop(void);
+uint8_t trace_is_running(void);
+void trace_clear(void);
+
+void trace_record(trace_event_e event, uint16_t id);
+void trace_mark(uint16_t id);
+
+// Associates 'id' with a name in the dump (e.g. task IDs)
+void trace_name(trace_event_e event, uint16_t id, const char *name);
+
+int trace_dump_uart(void);
+
+#endif // TRACE_H
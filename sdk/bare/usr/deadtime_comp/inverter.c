@@ -3,10 +3,13 @@
 #include "inverter.h"
 #include "../../drv/io.h"
 #include "../../drv/pwm.h"
+#include "../../sys/symbols.h"
 #include <math.h>
 
 double LOG_dcomp = 0.0;
 
+SYMBOL_EXPORT(LOG_dcomp, DOUBLE);
+
 static double dtc_dcomp = 0.0;
 static double dtc_tau = 0.0;
 
@@ -5,6 +5,7 @@
 #include "../../sys/scheduler.h"
 #include "../../sys/defines.h"
 #include "../../sys/debug.h"
+#include "../../sys/symbols.h"
 #include "machine.h"
 #include <math.h>
 
@@ -19,6 +20,11 @@ double LOG_Ia_b       = 0.0;
 double LOG_Vab        = 0.0;
 double LOG_Vab_star   = 0.0;
 
+SYMBOL_EXPORT(LOG_Ia, DOUBLE);
+SYMBOL_EXPORT(LOG_Ia_b, DOUBLE);
+SYMBOL_EXPORT(LOG_Vab, DOUBLE);
+SYMBOL_EXPORT(LOG_Vab_star, DOUBLE);
+
 // Set by command
 static double I_mag_star  = 0.0;
 static double I_freq_star = 0.0;
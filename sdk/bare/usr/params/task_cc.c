@@ -6,7 +6,9 @@
 #include "cmd/cmd_cc.h"
 #include "../../sys/debug.h"
 #include "../../sys/defines.h"
+#include "../../sys/log.h"
 #include "../../sys/scheduler.h"
+#include "../../sys/symbols.h"
 #include "../../sys/transform.h"
 #include "../../drv/analog.h"
 #include "../../drv/encoder.h"
@@ -33,6 +35,14 @@ double LOG_Vd_star = 0.0;
 double LOG_Vq_star = 0.0;
 double LOG_omega_e_avg  = 0.0;
 
+SYMBOL_EXPORT(LOG_Id, DOUBLE);
+SYMBOL_EXPORT(LOG_Iq, DOUBLE);
+SYMBOL_EXPORT(LOG_Id_star, DOUBLE);
+SYMBOL_EXPORT(LOG_Iq_star, DOUBLE);
+SYMBOL_EXPORT(LOG_Vd_star, DOUBLE);
+SYMBOL_EXPORT(LOG_Vq_star, DOUBLE);
+SYMBOL_EXPORT(LOG_omega_e_avg, DOUBLE);
+
 static double Id_star = 0.0;
 static double Iq_star = 0.0;
 
@@ -71,8 +81,12 @@ uint8_t task_cc_is_inited(void)
 void task_cc_init(void)
 {
 	// Register task with scheduler
+	//
+	// Current control runs in the real-time tier so it
+	// starts right after each tick, regardless of how
+	// long the background tasks take
 	scheduler_tcb_init(&tcb, task_cc_callback, NULL, "cc", TASK_CC_INTERVAL_USEC);
-	scheduler_tcb_register(&tcb);
+	scheduler_tcb_register_rt(&tcb);
 }
 
 void task_cc_deinit(void)
@@ -249,7 +263,7 @@ void task_cc_callback(void *arg)
 	// Convert ABC to DQ
 	// ---------------------
 	double Idq0[3];
-	transform_dqz(theta_da, Iabc, Idq0);
+	transform_dqz(TRANS_DQZ_C_INVARIANT_POWER, theta_da, Iabc, Idq0);
 
 
 	// -----------------------------
@@ -291,7 +305,7 @@ void task_cc_callback(void *arg)
 	Vdq0[0] = Vd_star;
 	Vdq0[1] = Vq_star;
 	Vdq0[2] = 0.0;
-	transform_dqz_inverse(theta_da, Vabc_star, Vdq0);
+	transform_dqz_inverse(TRANS_DQZ_C_INVARIANT_POWER, theta_da, Vabc_star, Vdq0);
 
 
 	// ------------------------------------
@@ -341,6 +355,9 @@ void task_cc_callback(void *arg)
 	LOG_Iq_star = Iq_star;
 	LOG_Id = Id;
 	LOG_Iq = Iq;
+
+	// Commit a coherent snapshot, if the log group asks for one
+	log_sample_now();
 }
 
 void task_cc_clear(void)
@@ -5,6 +5,7 @@
 #include "cmd/cmd_cc.h"
 #include "../../sys/debug.h"
 #include "../../sys/defines.h"
+#include "../../sys/log.h"
 #include "../../sys/scheduler.h"
 #include "../../sys/transform.h"
 #include "../../drv/analog.h"
@@ -55,6 +56,11 @@ uint8_t task_cc_is_inited(void)
 	return scheduler_tcb_is_registered(&tcb);
 }
 
+task_control_block_t *task_cc_get_tcb(void)
+{
+	return &tcb;
+}
+
 void task_cc_init(void)
 {
 	// Register task with scheduler
@@ -133,11 +139,11 @@ void task_cc_callback(void *arg)
 	// ---------------------
 #ifndef CC_FIND_DQ_FRAME_OFFSET
 	double Idq0[3];
-	transform_dqz(theta_da, Iabc, Idq0);
+	transform_dqz(TRANS_DQZ_C_INVARIANT_POWER, theta_da, Iabc, Idq0);
 #else
 	double Idq0[3];
 	double Ixyz[3];
-	transform_clarke(Iabc, Ixyz);
+	transform_clarke(TRANS_DQZ_C_INVARIANT_POWER, Iabc, Ixyz);
 	Ixyz[1] = 1.0;
 	transform_park(theta_da, Ixyz, Idq0);
 
@@ -217,7 +223,7 @@ void task_cc_callback(void *arg)
 	Vdq0[0] = Vd_star;
 	Vdq0[1] = Vq_star;
 	Vdq0[2] = 0.0;
-	transform_dqz_inverse(theta_da, Vabc_star, Vdq0);
+	transform_dqz_inverse(TRANS_DQZ_C_INVARIANT_POWER, theta_da, Vabc_star, Vdq0);
 
 	// ------------------------------------
 	// Saturate Vabc_star to CC_BUS_VOLTAGE
@@ -239,6 +245,9 @@ void task_cc_callback(void *arg)
 	pwm_set_duty(CC_PHASE_A_PWM_LEG_IDX, (((Vabc_star[0] / CC_BUS_VOLTAGE) + 1.0) / 2.0));
 	pwm_set_duty(CC_PHASE_B_PWM_LEG_IDX, (((Vabc_star[1] / CC_BUS_VOLTAGE) + 1.0) / 2.0));
 	pwm_set_duty(CC_PHASE_C_PWM_LEG_IDX, (((Vabc_star[2] / CC_BUS_VOLTAGE) + 1.0) / 2.0));
+
+	// Commit a coherent snapshot, if the log group asks for one
+	log_sample_now();
 }
 
 #endif // APP_PMSM_MC
@@ -37,6 +37,7 @@ void task_cc_deinit(void);
 void task_cc_callback(void *arg);
 
 uint8_t task_cc_is_inited(void);
+task_control_block_t *task_cc_get_tcb(void);
 
 void task_cc_set_Id_star(double my_Id_star);
 void task_cc_set_Iq_star(double my_Iq_star);
@@ -52,6 +52,11 @@ void task_mc_init(void)
 {
 	// Register task with scheduler
 	scheduler_tcb_init(&tcb, task_mc_callback, NULL, "mc", TASK_MC_INTERVAL_USEC);
+
+	// Always run right after the cc sample this speed loop update
+	// lines up with, so Iq* reaches cc exactly one cc period later
+	// no matter which task was started first
+	scheduler_tcb_depends_on(&tcb, task_cc_get_tcb());
 	scheduler_tcb_register(&tcb);
 }
 
@@ -3,12 +3,17 @@
 #include "task_test.h"
 #include "../../sys/defines.h"
 #include "../../sys/scheduler.h"
+#include "../../sys/symbols.h"
 
 #define MAX_VALUE	(100)
 #define MIN_VALUE	(-100)
 
 int32_t LOGGING_tri_i;
 double LOGGING_tri_d;
+
+SYMBOL_EXPORT(LOGGING_tri_i, INT);
+SYMBOL_EXPORT(LOGGING_tri_d, DOUBLE);
+
 static int dir = 1;
 
 static task_control_block_t tcb;
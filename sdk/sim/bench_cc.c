@@ -0,0 +1,98 @@
+// Benchmarks the pmsm_mc current control callback on the host
+//
+// Each call sees a new encoder position and phase current sample so
+// the transforms don't run on constant inputs. Reports the best and
+// mean time per call over batches of calls.
+
+#include "sim.h"
+#include "drv/bsp.h"
+#include "drv/encoder.h"
+#include "usr/pmsm_mc/task_cc.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ANALOG_BASE_ADDR	(0x43C00000)
+#define ENCODER_BASE_ADDR	(0x43C10000)
+
+#define BATCH_SIZE			(1000)
+
+static uint64_t _host_nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * NSEC_PER_SEC + (uint64_t) ts.tv_nsec;
+}
+
+static void _set_inputs(uint32_t i)
+{
+	// Slowly turning rotor with balanced phase currents
+	uint32_t position = (i * 7) % ENCODER_PULSES_PER_REV;
+	double theta = 2.0 * M_PI * (double) (i % 200) / 200.0;
+
+	sim_reg_write(ENCODER_BASE_ADDR + 1*sizeof(uint32_t), position);
+	for (int ch = 0; ch < 3; ch++) {
+		double amps = 2.0 * sin(theta - ch * 2.0 * M_PI / 3.0);
+		sim_reg_write(ANALOG_BASE_ADDR + ch*sizeof(uint32_t), (uint32_t) (int16_t) (amps * 400));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t num_batches = 1000;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			num_batches = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n batches]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (num_batches == 0) {
+		num_batches = 1;
+	}
+
+	sim_clock_init();
+	bsp_init();
+
+	// Warm up caches and branch predictors
+	for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+		_set_inputs(i);
+		task_cc_callback(NULL);
+	}
+
+	uint64_t best = UINT64_MAX;
+	uint64_t total = 0;
+
+	for (uint32_t b = 0; b < num_batches; b++) {
+		uint64_t start = _host_nsec();
+
+		for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+			_set_inputs(b * BATCH_SIZE + i);
+			task_cc_callback(NULL);
+		}
+
+		uint64_t elapsed = _host_nsec() - start;
+		total += elapsed;
+		if (elapsed < best) {
+			best = elapsed;
+		}
+	}
+
+	double best_ns = (double) best / BATCH_SIZE;
+	double mean_ns = (double) total / ((double) num_batches * BATCH_SIZE);
+
+	printf("task_cc_callback: %lu calls\n", (unsigned long) num_batches * BATCH_SIZE);
+	printf("  best: %.1f ns/call\n", best_ns);
+	printf("  mean: %.1f ns/call (%.2f%% of %d usec interval)\n",
+			mean_ns, 100.0 * mean_ns / (TASK_CC_INTERVAL_USEC * 1000.0), TASK_CC_INTERVAL_USEC);
+
+	return 0;
+}
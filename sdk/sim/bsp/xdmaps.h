@@ -0,0 +1,89 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Copies happen in XDmaPs_Start() and raise the channel's done
+// interrupt, so the done handler runs once IRQs are unmasked, like
+// after a real transfer. Addresses are host pointers, and there is
+// no cache to maintain.
+
+#ifndef XDMAPS_H
+#define XDMAPS_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xstatus.h"
+
+#define XDMAPS_CHANNELS_PER_DEV		8
+
+typedef struct {
+	u16 DeviceId;
+	u32 BaseAddress;
+} XDmaPs_Config;
+
+typedef struct {
+	unsigned int EndianSwapSize;
+	unsigned int DstCacheCtrl;
+	unsigned int DstProtCtrl;
+	unsigned int DstBurstLen;
+	unsigned int DstBurstSize;
+	unsigned int DstInc;
+	unsigned int SrcCacheCtrl;
+	unsigned int SrcProtCtrl;
+	unsigned int SrcBurstLen;
+	unsigned int SrcBurstSize;
+	unsigned int SrcInc;
+} XDmaPs_ChanCtrl;
+
+// u32 on the target
+typedef struct {
+	UINTPTR SrcAddr;
+	UINTPTR DstAddr;
+	unsigned int Length;
+} XDmaPs_BD;
+
+typedef struct {
+	XDmaPs_ChanCtrl ChanCtrl;
+	XDmaPs_BD BD;
+	void *UserDmaProg;
+	int UserDmaProgLength;
+	void *GeneratedDmaProg;
+	int GeneratedDmaProgLength;
+	int DmaStatus;
+	u32 ChanFaultType;
+	u32 ChanFaultPCAddr;
+} XDmaPs_Cmd;
+
+typedef void (*XDmaPsDoneHandler)(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef);
+typedef void (*XDmaPsFaultHandler)(unsigned int Channel, XDmaPs_Cmd *DmaCmd, void *CallbackRef);
+
+typedef struct {
+	XDmaPsDoneHandler DoneHandler;
+	void *DoneRef;
+	XDmaPs_Cmd *DmaCmdToHw;
+} XDmaPs_ChannelData;
+
+typedef struct {
+	XDmaPs_Config Config;
+	u32 IsReady;
+	XDmaPsFaultHandler FaultHandler;
+	void *FaultRef;
+	XDmaPs_ChannelData Chans[XDMAPS_CHANNELS_PER_DEV];
+} XDmaPs;
+
+XDmaPs_Config *XDmaPs_LookupConfig(u16 DeviceId);
+int XDmaPs_CfgInitialize(XDmaPs *InstPtr, XDmaPs_Config *Config, u32 EffectiveAddr);
+int XDmaPs_Start(XDmaPs *InstPtr, unsigned int Channel, XDmaPs_Cmd *Cmd, int HoldDmaProg);
+int XDmaPs_IsActive(XDmaPs *InstPtr, unsigned int Channel);
+int XDmaPs_SetDoneHandler(XDmaPs *InstPtr, unsigned Channel, XDmaPsDoneHandler DoneHandler, void *CallbackRef);
+int XDmaPs_SetFaultHandler(XDmaPs *InstPtr, XDmaPsFaultHandler FaultHandler, void *CallbackRef);
+
+void XDmaPs_DoneISR_0(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_1(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_2(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_3(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_4(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_5(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_6(XDmaPs *InstPtr);
+void XDmaPs_DoneISR_7(XDmaPs *InstPtr);
+void XDmaPs_FaultISR(XDmaPs *InstPtr);
+
+#endif // XDMAPS_H
@@ -0,0 +1,32 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Pins are plain storage: outputs hold the last written value and
+// inputs read whatever was injected with sim_gpio_set_pin().
+
+#ifndef XGPIOPS_H
+#define XGPIOPS_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xstatus.h"
+
+#define XGPIOPS_NUM_PINS	(118)
+
+typedef struct {
+	u16 DeviceId;
+	u32 BaseAddr;
+} XGpioPs_Config;
+
+typedef struct {
+	XGpioPs_Config GpioConfig;
+	u32 IsReady;
+} XGpioPs;
+
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId);
+s32 XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr);
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction);
+void XGpioPs_SetOutputEnablePin(XGpioPs *InstancePtr, u32 Pin, u32 OpEnable);
+void XGpioPs_WritePin(XGpioPs *InstancePtr, u32 Pin, u32 Data);
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin);
+
+#endif // XGPIOPS_H
@@ -0,0 +1,11 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+#define Xil_ICacheEnable()
+#define Xil_ICacheDisable()
+#define Xil_DCacheEnable()
+#define Xil_DCacheDisable()
+
+#endif // XIL_CACHE_H
@@ -0,0 +1,30 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// IRQ masking maps onto the virtual clock (sim_clock.c): a masked
+// interrupt stays pending until Xil_ExceptionEnable() is called.
+// The simulator never nests interrupts, so the nesting macros are
+// no-ops.
+
+#ifndef XIL_EXCEPTION_H
+#define XIL_EXCEPTION_H
+
+#include "xil_types.h"
+
+#define XIL_EXCEPTION_ID_INT	(5U)
+
+typedef void (*Xil_ExceptionHandler)(void *data);
+typedef void (*Xil_InterruptHandler)(void *data);
+
+void Xil_ExceptionInit(void);
+void Xil_ExceptionRegisterHandler(u32 Exception_id, Xil_ExceptionHandler Handler, void *Data);
+void Xil_ExceptionEnable(void);
+void Xil_ExceptionDisable(void);
+
+#define Xil_EnableNestedInterrupts()
+#define Xil_DisableNestedInterrupts()
+
+// Replaces the WFI instruction: advances virtual time to the next
+// interrupt and marks it pending
+void sim_wait_for_interrupt(void);
+
+#endif // XIL_EXCEPTION_H
@@ -0,0 +1,13 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Register accesses go to the simulated peripheral layer (sim_io.c).
+
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+u32 Xil_In32(UINTPTR Addr);
+void Xil_Out32(UINTPTR Addr, u32 Value);
+
+#endif // XIL_IO_H
@@ -0,0 +1,32 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Only the parameters the firmware uses are defined. Values match
+// the generated BSP so timing math is identical on host and target.
+
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#define XPAR_CPU_CORTEXA9_CORE_CLOCK_FREQ_HZ		666666687
+
+#define XPAR_GLOBAL_TMR_BASEADDR					0xF8F00200U
+
+#define XPAR_PS7_SCUGIC_0_DEVICE_ID					0U
+#define XPAR_PS7_GPIO_0_DEVICE_ID					0
+#define XPAR_XUARTPS_0_DEVICE_ID					0
+#define XPAR_XUARTPS_0_INTR							59U
+
+#define XPAR_XDMAPS_1_DEVICE_ID						1
+#define XPAR_XDMAPS_0_FAULT_INTR					45U
+#define XPAR_XDMAPS_0_DONE_INTR_0					46U
+#define XPAR_XDMAPS_0_DONE_INTR_1					47U
+#define XPAR_XDMAPS_0_DONE_INTR_2					48U
+#define XPAR_XDMAPS_0_DONE_INTR_3					49U
+#define XPAR_XDMAPS_0_DONE_INTR_4					72U
+#define XPAR_XDMAPS_0_DONE_INTR_5					73U
+#define XPAR_XDMAPS_0_DONE_INTR_6					74U
+#define XPAR_XDMAPS_0_DONE_INTR_7					75U
+
+#define XPAR_CONTROL_TIMER_0_DEVICE_ID				0
+#define XPAR_FABRIC_CONTROL_TIMER_0_INTERRUPT_INTR	61U
+
+#endif // XPARAMETERS_H
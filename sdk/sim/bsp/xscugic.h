@@ -0,0 +1,32 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Connected handlers are called directly by the simulated interrupt
+// lines in sim_clock.c; trigger types are not modeled.
+
+#ifndef XSCUGIC_H
+#define XSCUGIC_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xil_exception.h"
+#include "xstatus.h"
+
+typedef struct {
+	u16 DeviceId;
+	u32 CpuBaseAddress;
+	u32 DistBaseAddress;
+} XScuGic_Config;
+
+typedef struct {
+	XScuGic_Config Config;
+	u32 IsReady;
+} XScuGic;
+
+XScuGic_Config *XScuGic_LookupConfig(u16 DeviceId);
+s32 XScuGic_CfgInitialize(XScuGic *InstancePtr, XScuGic_Config *ConfigPtr, u32 EffectiveAddr);
+void XScuGic_SetPriorityTriggerType(XScuGic *InstancePtr, u32 Int_Id, u8 Priority, u8 Trigger);
+s32 XScuGic_Connect(XScuGic *InstancePtr, u32 Int_Id, Xil_InterruptHandler Handler, void *CallBackRef);
+void XScuGic_Enable(XScuGic *InstancePtr, u32 Int_Id);
+void XScuGic_InterruptHandler(XScuGic *InstancePtr);
+
+#endif // XSCUGIC_H
@@ -0,0 +1,9 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#define XST_SUCCESS		(0L)
+#define XST_FAILURE		(1L)
+
+#endif // XSTATUS_H
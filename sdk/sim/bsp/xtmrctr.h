@@ -0,0 +1,33 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Models the AXI timer as a 200 MHz down-counter: once started with
+// auto-reload it interrupts every (0xFFFFFFFF - reset value + 2) cycles.
+
+#ifndef XTMRCTR_H
+#define XTMRCTR_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xstatus.h"
+
+#define XTC_INT_MODE_OPTION		0x00000008UL
+#define XTC_AUTO_RELOAD_OPTION	0x00000004UL
+
+typedef void (*XTmrCtr_Handler)(void *CallBackRef, u8 TmrCtrNumber);
+
+typedef struct {
+	XTmrCtr_Handler Handler;
+	void *CallBackRef;
+	u32 Options;
+	u32 ResetValue;
+	u32 IsReady;
+} XTmrCtr;
+
+int XTmrCtr_Initialize(XTmrCtr *InstancePtr, u16 DeviceId);
+void XTmrCtr_SetHandler(XTmrCtr *InstancePtr, XTmrCtr_Handler FuncPtr, void *CallBackRef);
+void XTmrCtr_SetOptions(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 Options);
+void XTmrCtr_SetResetValue(XTmrCtr *InstancePtr, u8 TmrCtrNumber, u32 ResetValue);
+void XTmrCtr_Start(XTmrCtr *InstancePtr, u8 TmrCtrNumber);
+void XTmrCtr_InterruptHandler(void *InstancePtr);
+
+#endif // XTMRCTR_H
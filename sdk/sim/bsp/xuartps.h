@@ -0,0 +1,55 @@
+// Host simulation stand-in for the Xilinx BSP header of the same name
+//
+// Normal mode transmits to stdout and receives from stdin without
+// blocking. Local loopback mode echoes sent bytes back to the receiver.
+// The RX trigger interrupt is raised while input is waiting and it is
+// enabled in the interrupt mask; other interrupt sources are not modeled.
+
+#ifndef XUARTPS_H
+#define XUARTPS_H
+
+#include "xil_types.h"
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+
+#define XUARTPS_OPER_MODE_NORMAL		(u8)0x00U
+#define XUARTPS_OPER_MODE_LOCAL_LOOP	(u8)0x02U
+
+#define XUARTPS_FIFO_SIZE				(64)
+
+#define XUARTPS_ISR_OFFSET				0x0014U
+#define XUARTPS_IXR_RXOVR				0x00000001U
+
+#define XUartPs_ReadReg(BaseAddress, RegOffset) \
+	Xil_In32((BaseAddress) + (u32)(RegOffset))
+
+#define XUartPs_WriteReg(BaseAddress, RegOffset, RegisterValue) \
+	Xil_Out32((BaseAddress) + (u32)(RegOffset), (u32)(RegisterValue))
+
+typedef struct {
+	u16 DeviceId;
+	u32 BaseAddress;
+} XUartPs_Config;
+
+typedef struct {
+	XUartPs_Config Config;
+	u8 OperMode;
+	u8 LoopBuffer[XUARTPS_FIFO_SIZE];
+	u32 LoopCount;
+	u32 IntrMask;
+	u32 IsReady;
+} XUartPs;
+
+XUartPs_Config *XUartPs_LookupConfig(u16 DeviceId);
+s32 XUartPs_CfgInitialize(XUartPs *InstancePtr, XUartPs_Config *Config, u32 EffectiveAddr);
+s32 XUartPs_SelfTest(XUartPs *InstancePtr);
+void XUartPs_SetOperMode(XUartPs *InstancePtr, u8 OperationMode);
+u32 XUartPs_Send(XUartPs *InstancePtr, u8 *BufferPtr, u32 NumBytes);
+u32 XUartPs_Recv(XUartPs *InstancePtr, u8 *BufferPtr, u32 NumBytes);
+u32 XUartPs_IsSending(XUartPs *InstancePtr);
+void XUartPs_SetFifoThreshold(XUartPs *InstancePtr, u8 TriggerLevel);
+void XUartPs_SetInterruptMask(XUartPs *InstancePtr, u32 Mask);
+u32 XUartPs_IsReceiveData(u32 BaseAddress);
+
+#endif // XUARTPS_H
@@ -0,0 +1,69 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+#define NSEC_PER_SEC		(1000000000ULL)
+
+// ------------
+// Virtual clock
+// ------------
+//
+// Time only moves when the firmware waits for an interrupt (WFI)
+// or touches a peripheral register (see sim_clock_set_bus_cost).
+// Everything else is free, so the scheduler runs as fast as the
+// host allows and every run is deterministic.
+
+void sim_clock_init(void);
+uint64_t sim_clock_now_nsec(void);
+void sim_clock_advance(uint64_t nsec);
+void sim_clock_set_stop(uint64_t nsec);
+void sim_clock_set_bus_cost(uint64_t nsec);
+void sim_clock_set_realtime(int enable);
+
+// Charges one bus access to the clock, returns the new time
+uint64_t sim_clock_bus_access(void);
+
+// ------------
+// Interrupts
+// ------------
+//
+// One line per GIC interrupt ID. Pending lines are delivered, most
+// urgent priority first, whenever IRQs are unmasked. Interrupts never
+// nest.
+
+#define SIM_NUM_IRQS		(96)
+
+void sim_irq_connect(uint32_t int_id, void (*isr)(void *), void *arg);
+void sim_irq_set_priority(uint32_t int_id, uint8_t priority);
+void sim_irq_enable(uint32_t int_id);
+void sim_irq_raise(uint32_t int_id);
+
+// Raises 'int_id' every 'period_nsec' of virtual time
+void sim_timer_start(uint64_t period_nsec, uint32_t int_id);
+
+// Prints run summary to stderr and exits the process
+void sim_finish(int status);
+
+// ------------
+// Peripherals
+// ------------
+//
+// Direct register access which bypasses the bus cost and register
+// hooks; used to inject ADC samples, encoder counts, etc.
+
+uint32_t sim_reg_read(uintptr_t addr);
+void sim_reg_write(uintptr_t addr, uint32_t value);
+
+void sim_gpio_set_pin(uint32_t pin, uint32_t value);
+
+// Replaces stdin with timed commands, see sim_uart.c
+int sim_uart_load_script(const char *path);
+
+// Limits TX to the line rate of 'baud' (8N1), 0 for unlimited
+void sim_uart_set_baud(uint32_t baud);
+
+// Raises the UART interrupt if it is enabled and input is waiting
+void sim_uart_poll(void);
+
+#endif // SIM_H
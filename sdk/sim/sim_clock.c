@@ -0,0 +1,245 @@
+#include "sim.h"
+#include "xil_exception.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct sim_irq_t {
+	void (*isr)(void *);
+	void *arg;
+	uint8_t priority;
+	int enabled;
+	int pending;
+} sim_irq_t;
+
+static uint64_t now_nsec = 0;
+static uint64_t stop_nsec = UINT64_MAX;
+static uint64_t bus_cost_nsec = 0;
+static int realtime = 0;
+
+static sim_irq_t irqs[SIM_NUM_IRQS];
+
+// Periodic timer, raises 'timer_irq' every 'timer_period_nsec'
+static int timer_irq = -1;
+static uint64_t timer_period_nsec = 0;
+static uint64_t timer_next_nsec = 0;
+
+static int irq_masked = 1;
+static int in_isr = 0;
+
+static uint64_t num_irqs = 0;
+static uint64_t host_start_nsec = 0;
+
+static uint64_t _host_nsec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * NSEC_PER_SEC + (uint64_t) ts.tv_nsec;
+}
+
+static void _pace(void)
+{
+	uint64_t target = host_start_nsec + now_nsec;
+	uint64_t host_now = _host_nsec();
+	if (target > host_now) {
+		struct timespec ts;
+		ts.tv_sec = (target - host_now) / NSEC_PER_SEC;
+		ts.tv_nsec = (target - host_now) % NSEC_PER_SEC;
+		nanosleep(&ts, NULL);
+	}
+}
+
+// Most urgent pending and enabled interrupt, or -1
+static int _next_irq(void)
+{
+	int best = -1;
+
+	for (int i = 0; i < SIM_NUM_IRQS; i++) {
+		if (irqs[i].pending && irqs[i].enabled && irqs[i].isr != NULL) {
+			if (best < 0 || irqs[i].priority < irqs[best].priority) {
+				best = i;
+			}
+		}
+	}
+
+	return best;
+}
+
+static void _deliver(void)
+{
+	while (!irq_masked && !in_isr) {
+		int i = _next_irq();
+		if (i < 0) {
+			break;
+		}
+
+		irqs[i].pending = 0;
+		num_irqs++;
+
+		// Hardware masks IRQs on exception entry
+		in_isr = 1;
+		irq_masked = 1;
+		irqs[i].isr(irqs[i].arg);
+		irq_masked = 0;
+		in_isr = 0;
+	}
+}
+
+static void _poll(void)
+{
+	if (timer_irq >= 0 && now_nsec >= timer_next_nsec) {
+		// Like the real timer, expiries that pile up while the
+		// interrupt is pending collapse into one
+		while (timer_next_nsec <= now_nsec) {
+			timer_next_nsec += timer_period_nsec;
+		}
+
+		irqs[timer_irq].pending = 1;
+	}
+
+	_deliver();
+}
+
+void sim_clock_init(void)
+{
+	host_start_nsec = _host_nsec();
+}
+
+uint64_t sim_clock_now_nsec(void)
+{
+	return now_nsec;
+}
+
+void sim_clock_advance(uint64_t nsec)
+{
+	now_nsec += nsec;
+
+	if (now_nsec >= stop_nsec) {
+		sim_finish(0);
+	}
+
+	_poll();
+}
+
+void sim_clock_set_stop(uint64_t nsec)
+{
+	stop_nsec = nsec;
+}
+
+void sim_clock_set_bus_cost(uint64_t nsec)
+{
+	bus_cost_nsec = nsec;
+}
+
+void sim_clock_set_realtime(int enable)
+{
+	realtime = enable;
+}
+
+uint64_t sim_clock_bus_access(void)
+{
+	if (bus_cost_nsec > 0) {
+		sim_clock_advance(bus_cost_nsec);
+	}
+
+	return now_nsec;
+}
+
+void sim_irq_connect(uint32_t int_id, void (*isr)(void *), void *arg)
+{
+	if (int_id < SIM_NUM_IRQS) {
+		irqs[int_id].isr = isr;
+		irqs[int_id].arg = arg;
+	}
+}
+
+void sim_irq_set_priority(uint32_t int_id, uint8_t priority)
+{
+	if (int_id < SIM_NUM_IRQS) {
+		irqs[int_id].priority = priority;
+	}
+}
+
+void sim_irq_enable(uint32_t int_id)
+{
+	if (int_id < SIM_NUM_IRQS) {
+		irqs[int_id].enabled = 1;
+	}
+}
+
+void sim_irq_raise(uint32_t int_id)
+{
+	if (int_id < SIM_NUM_IRQS) {
+		irqs[int_id].pending = 1;
+		_deliver();
+	}
+}
+
+void sim_timer_start(uint64_t period_nsec, uint32_t int_id)
+{
+	timer_irq = (int) int_id;
+	timer_period_nsec = period_nsec;
+	timer_next_nsec = now_nsec + period_nsec;
+}
+
+void sim_wait_for_interrupt(void)
+{
+	// Level-triggered sources which are ready right now
+	sim_uart_poll();
+
+	if (_next_irq() >= 0) {
+		return;
+	}
+
+	if (timer_irq < 0) {
+		fprintf(stderr, "SIM: WFI with no interrupt source, stopping\n");
+		sim_finish(1);
+	}
+
+	sim_clock_advance(timer_next_nsec - now_nsec);
+
+	if (realtime) {
+		_pace();
+	}
+}
+
+void sim_finish(int status)
+{
+	fflush(stdout);
+
+	double host_sec = (double) (_host_nsec() - host_start_nsec) / 1e9;
+	double sim_sec = (double) now_nsec / 1e9;
+
+	fprintf(stderr, "SIM: %.3f s simulated in %.3f s host (%.1fx), %llu interrupts\n",
+			sim_sec, host_sec, host_sec > 0.0 ? sim_sec / host_sec : 0.0,
+			(unsigned long long) num_irqs);
+
+	exit(status);
+}
+
+// ------------
+// Xilinx exception API
+// ------------
+
+void Xil_ExceptionInit(void)
+{
+}
+
+void Xil_ExceptionRegisterHandler(u32 Exception_id, Xil_ExceptionHandler Handler, void *Data)
+{
+	// The simulated GIC calls the connected handlers directly
+	(void) Exception_id;
+	(void) Handler;
+	(void) Data;
+}
+
+void Xil_ExceptionEnable(void)
+{
+	irq_masked = 0;
+	_deliver();
+}
+
+void Xil_ExceptionDisable(void)
+{
+	irq_masked = 1;
+}
@@ -0,0 +1,55 @@
+#include "sim.h"
+#include "xgpiops.h"
+
+static XGpioPs_Config gpio_config = { 0, 0xE000A000U };
+
+static u32 pins[XGPIOPS_NUM_PINS];
+
+void sim_gpio_set_pin(uint32_t pin, uint32_t value)
+{
+	if (pin < XGPIOPS_NUM_PINS) {
+		pins[pin] = value ? 1 : 0;
+	}
+}
+
+XGpioPs_Config *XGpioPs_LookupConfig(u16 DeviceId)
+{
+	(void) DeviceId;
+	return &gpio_config;
+}
+
+s32 XGpioPs_CfgInitialize(XGpioPs *InstancePtr, XGpioPs_Config *ConfigPtr, u32 EffectiveAddr)
+{
+	(void) EffectiveAddr;
+
+	InstancePtr->GpioConfig = *ConfigPtr;
+	InstancePtr->IsReady = 1;
+
+	return XST_SUCCESS;
+}
+
+void XGpioPs_SetDirectionPin(XGpioPs *InstancePtr, u32 Pin, u32 Direction)
+{
+	(void) InstancePtr;
+	(void) Pin;
+	(void) Direction;
+}
+
+void XGpioPs_SetOutputEnablePin(XGpioPs *InstancePtr, u32 Pin, u32 OpEnable)
+{
+	(void) InstancePtr;
+	(void) Pin;
+	(void) OpEnable;
+}
+
+void XGpioPs_WritePin(XGpioPs *InstancePtr, u32 Pin, u32 Data)
+{
+	(void) InstancePtr;
+	sim_gpio_set_pin(Pin, Data);
+}
+
+u32 XGpioPs_ReadPin(XGpioPs *InstancePtr, u32 Pin)
+{
+	(void) InstancePtr;
+	return Pin < XGPIOPS_NUM_PINS ? pins[Pin] : 0;
+}
@@ -0,0 +1,88 @@
+#include "sim.h"
+#include "xil_io.h"
+#include "xparameters.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Peripheral registers live in 4 KB pages which are created the
+// first time an address inside them is touched. Unwritten registers
+// read as zero, like most of the AMDC IP blocks after reset.
+
+#define SIM_PAGE_SIZE		(4096)
+#define SIM_PAGE_REGS		(SIM_PAGE_SIZE / sizeof(uint32_t))
+#define SIM_MAX_PAGES		(32)
+
+#define GTIMER_BASE_ADDR		(XPAR_GLOBAL_TMR_BASEADDR)
+#define GTIMER_COUNTER_LOWER	(GTIMER_BASE_ADDR + 0x00)
+#define GTIMER_COUNTER_UPPER	(GTIMER_BASE_ADDR + 0x04)
+#define GTIMER_TICKS_PER_SEC	(XPAR_CPU_CORTEXA9_CORE_CLOCK_FREQ_HZ / 2)
+
+typedef struct sim_page_t {
+	uintptr_t base;
+	uint32_t regs[SIM_PAGE_REGS];
+} sim_page_t;
+
+static sim_page_t *pages[SIM_MAX_PAGES];
+static int num_pages = 0;
+
+static uint32_t *_reg(uintptr_t addr)
+{
+	uintptr_t base = addr & ~((uintptr_t) SIM_PAGE_SIZE - 1);
+
+	for (int i = 0; i < num_pages; i++) {
+		if (pages[i]->base == base) {
+			return &pages[i]->regs[(addr - base) / sizeof(uint32_t)];
+		}
+	}
+
+	if (num_pages >= SIM_MAX_PAGES) {
+		fprintf(stderr, "SIM: out of register pages at 0x%08lX\n", (unsigned long) addr);
+		sim_finish(1);
+	}
+
+	sim_page_t *p = calloc(1, sizeof(sim_page_t));
+	p->base = base;
+	pages[num_pages++] = p;
+
+	return &p->regs[(addr - base) / sizeof(uint32_t)];
+}
+
+static uint64_t _gtimer_ticks(uint64_t nsec)
+{
+	// Split off whole seconds so the multiply can't overflow
+	uint64_t sec = nsec / NSEC_PER_SEC;
+	uint64_t rem = nsec % NSEC_PER_SEC;
+
+	return sec * GTIMER_TICKS_PER_SEC + (rem * GTIMER_TICKS_PER_SEC) / NSEC_PER_SEC;
+}
+
+uint32_t sim_reg_read(uintptr_t addr)
+{
+	return *_reg(addr);
+}
+
+void sim_reg_write(uintptr_t addr, uint32_t value)
+{
+	*_reg(addr) = value;
+}
+
+u32 Xil_In32(UINTPTR Addr)
+{
+	uint64_t now = sim_clock_bus_access();
+
+	// The global timer counts the virtual clock
+	if (Addr == GTIMER_COUNTER_LOWER) {
+		return (u32) _gtimer_ticks(now);
+	}
+	if (Addr == GTIMER_COUNTER_UPPER) {
+		return (u32) (_gtimer_ticks(now) >> 32);
+	}
+
+	return sim_reg_read(Addr);
+}
+
+void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+	sim_clock_bus_access();
+	sim_reg_write(Addr, Value);
+}
@@ -0,0 +1,74 @@
+// AMDC host simulator
+//
+// Runs the unmodified firmware (main.c renamed to amdc_main) against
+// the simulated peripherals on a virtual clock.
+//
+// Commands are read from stdin and UART output goes to stdout, so a
+// session can be scripted:
+//
+//   echo "sched stats" | ./amdc_sim -t 60
+//
+// or, to type commands at given points in simulated time, from a
+// script file with one "<seconds> <command>" per line:
+//
+//   ./amdc_sim -t 60 -s session.txt
+
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int amdc_main(void);
+
+static void _usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-t seconds] [-s script] [-b bus_nsec] [-u baud] [-r]\n", prog);
+	fprintf(stderr, "  -t  stop after this much simulated time (default 10)\n");
+	fprintf(stderr, "  -s  read timed commands from script instead of stdin\n");
+	fprintf(stderr, "  -b  virtual time charged per register access (default 0)\n");
+	fprintf(stderr, "  -u  limit UART output to this baud rate (default unlimited)\n");
+	fprintf(stderr, "  -r  pace the virtual clock to wall clock time\n");
+}
+
+int main(int argc, char **argv)
+{
+	double stop_sec = 10.0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "t:s:b:u:rh")) != -1) {
+		switch (opt) {
+		case 't':
+			stop_sec = atof(optarg);
+			break;
+		case 's':
+			if (sim_uart_load_script(optarg) != 0) {
+				perror(optarg);
+				return 1;
+			}
+			break;
+		case 'b':
+			sim_clock_set_bus_cost(strtoull(optarg, NULL, 10));
+			break;
+		case 'u':
+			sim_uart_set_baud(strtoul(optarg, NULL, 10));
+			break;
+		case 'r':
+			sim_clock_set_realtime(1);
+			break;
+		default:
+			_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (stop_sec <= 0.0) {
+		_usage(argv[0]);
+		return 1;
+	}
+
+	sim_clock_set_stop((uint64_t) (stop_sec * NSEC_PER_SEC));
+	sim_clock_init();
+
+	// Never returns: the simulator exits when the stop time is reached
+	return amdc_main();
+}
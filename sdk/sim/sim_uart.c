@@ -0,0 +1,257 @@
+#include "sim.h"
+#include "xuartps.h"
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SCRIPT_LINE_LENGTH	(256)
+
+static XUartPs_Config uart_config = { 0, 0xE0000000U };
+
+static int stdin_open = 1;
+
+// TX line rate, 0 sends every byte instantly
+static uint64_t tx_nsec_per_byte = 0;
+
+// Virtual time at which the TX FIFO is empty again
+static uint64_t tx_idle_nsec = 0;
+
+// Instance driving the RX interrupt
+static XUartPs *uart = NULL;
+
+// Scripted input: each line is "<seconds> <command>" and the command
+// is typed once the virtual clock reaches that time
+static FILE *script = NULL;
+static uint64_t script_nsec = 0;
+static char script_line[SCRIPT_LINE_LENGTH + 2];
+static size_t script_len = 0;
+static size_t script_idx = 0;
+
+static int _script_next(void)
+{
+	char line[SCRIPT_LINE_LENGTH];
+
+	while (fgets(line, sizeof(line), script) != NULL) {
+		char *cmd;
+		double sec = strtod(line, &cmd);
+		if (cmd == line) {
+			// Blank or malformed line
+			continue;
+		}
+
+		while (*cmd == ' ' || *cmd == '\t') {
+			cmd++;
+		}
+		cmd[strcspn(cmd, "\r\n")] = '\0';
+
+		script_nsec = (uint64_t) (sec * NSEC_PER_SEC);
+		script_len = (size_t) snprintf(script_line, sizeof(script_line), "%s\r\n", cmd);
+		script_idx = 0;
+		return 1;
+	}
+
+	fclose(script);
+	script = NULL;
+	return 0;
+}
+
+int sim_uart_load_script(const char *path)
+{
+	script = fopen(path, "r");
+	if (script == NULL) {
+		return -1;
+	}
+
+	_script_next();
+	return 0;
+}
+
+static u32 _script_recv(u8 *BufferPtr, u32 NumBytes)
+{
+	if (script_idx >= script_len || sim_clock_now_nsec() < script_nsec) {
+		return 0;
+	}
+
+	u32 n = script_len - script_idx;
+	if (n > NumBytes) {
+		n = NumBytes;
+	}
+
+	memcpy(BufferPtr, &script_line[script_idx], n);
+	script_idx += n;
+
+	if (script_idx >= script_len && script != NULL) {
+		_script_next();
+	}
+
+	return n;
+}
+
+XUartPs_Config *XUartPs_LookupConfig(u16 DeviceId)
+{
+	(void) DeviceId;
+	return &uart_config;
+}
+
+s32 XUartPs_CfgInitialize(XUartPs *InstancePtr, XUartPs_Config *Config, u32 EffectiveAddr)
+{
+	(void) EffectiveAddr;
+
+	InstancePtr->Config = *Config;
+	InstancePtr->OperMode = XUARTPS_OPER_MODE_NORMAL;
+	InstancePtr->LoopCount = 0;
+	InstancePtr->IntrMask = 0;
+	InstancePtr->IsReady = 1;
+
+	uart = InstancePtr;
+
+	return XST_SUCCESS;
+}
+
+s32 XUartPs_SelfTest(XUartPs *InstancePtr)
+{
+	(void) InstancePtr;
+	return XST_SUCCESS;
+}
+
+void XUartPs_SetOperMode(XUartPs *InstancePtr, u8 OperationMode)
+{
+	InstancePtr->OperMode = OperationMode;
+	InstancePtr->LoopCount = 0;
+}
+
+u32 XUartPs_Send(XUartPs *InstancePtr, u8 *BufferPtr, u32 NumBytes)
+{
+	// Like the hardware, accept at most one FIFO worth per call
+	if (NumBytes > XUARTPS_FIFO_SIZE) {
+		NumBytes = XUARTPS_FIFO_SIZE;
+	}
+
+	if (InstancePtr->OperMode == XUARTPS_OPER_MODE_LOCAL_LOOP) {
+		u32 space = XUARTPS_FIFO_SIZE - InstancePtr->LoopCount;
+		if (NumBytes > space) {
+			NumBytes = space;
+		}
+
+		memcpy(&InstancePtr->LoopBuffer[InstancePtr->LoopCount], BufferPtr, NumBytes);
+		InstancePtr->LoopCount += NumBytes;
+		return NumBytes;
+	}
+
+	if (tx_nsec_per_byte != 0) {
+		// Only the free part of the FIFO takes new bytes
+		uint64_t now = sim_clock_now_nsec();
+		uint64_t queued = 0;
+		if (tx_idle_nsec > now) {
+			queued = (tx_idle_nsec - now + tx_nsec_per_byte - 1) / tx_nsec_per_byte;
+		} else {
+			tx_idle_nsec = now;
+		}
+
+		u32 space = (queued < XUARTPS_FIFO_SIZE) ? (XUARTPS_FIFO_SIZE - queued) : 0;
+		if (NumBytes > space) {
+			NumBytes = space;
+		}
+
+		tx_idle_nsec += NumBytes * tx_nsec_per_byte;
+	}
+
+	fwrite(BufferPtr, 1, NumBytes, stdout);
+	fflush(stdout);
+
+	return NumBytes;
+}
+
+void sim_uart_set_baud(uint32_t baud)
+{
+	// 8N1: ten bits on the line per byte
+	tx_nsec_per_byte = (baud > 0) ? (10 * NSEC_PER_SEC / baud) : 0;
+}
+
+u32 XUartPs_Recv(XUartPs *InstancePtr, u8 *BufferPtr, u32 NumBytes)
+{
+	if (InstancePtr->OperMode == XUARTPS_OPER_MODE_LOCAL_LOOP) {
+		if (NumBytes > InstancePtr->LoopCount) {
+			NumBytes = InstancePtr->LoopCount;
+		}
+
+		memcpy(BufferPtr, InstancePtr->LoopBuffer, NumBytes);
+		memmove(InstancePtr->LoopBuffer, &InstancePtr->LoopBuffer[NumBytes], InstancePtr->LoopCount - NumBytes);
+		InstancePtr->LoopCount -= NumBytes;
+		return NumBytes;
+	}
+
+	if (script != NULL || script_idx < script_len) {
+		return _script_recv(BufferPtr, NumBytes);
+	}
+
+	if (!stdin_open || NumBytes == 0) {
+		return 0;
+	}
+
+	// Never block, like reading an empty RX FIFO
+	struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+	if (poll(&pfd, 1, 0) <= 0) {
+		return 0;
+	}
+
+	ssize_t n = read(STDIN_FILENO, BufferPtr, NumBytes);
+	if (n <= 0) {
+		stdin_open = 0;
+		return 0;
+	}
+
+	return (u32) n;
+}
+
+u32 XUartPs_IsSending(XUartPs *InstancePtr)
+{
+	(void) InstancePtr;
+	return tx_idle_nsec > sim_clock_now_nsec();
+}
+
+static int _rx_ready(XUartPs *InstancePtr)
+{
+	if (InstancePtr->OperMode == XUARTPS_OPER_MODE_LOCAL_LOOP) {
+		return InstancePtr->LoopCount > 0;
+	}
+
+	if (script != NULL || script_idx < script_len) {
+		return script_idx < script_len && sim_clock_now_nsec() >= script_nsec;
+	}
+
+	if (!stdin_open) {
+		return 0;
+	}
+
+	// EOF also counts: the next read notices it and stops polling
+	struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+	return poll(&pfd, 1, 0) > 0;
+}
+
+void XUartPs_SetFifoThreshold(XUartPs *InstancePtr, u8 TriggerLevel)
+{
+	// Any waiting input counts as reaching the trigger level
+	(void) InstancePtr;
+	(void) TriggerLevel;
+}
+
+void XUartPs_SetInterruptMask(XUartPs *InstancePtr, u32 Mask)
+{
+	InstancePtr->IntrMask = Mask;
+}
+
+u32 XUartPs_IsReceiveData(u32 BaseAddress)
+{
+	(void) BaseAddress;
+	return uart != NULL && _rx_ready(uart);
+}
+
+void sim_uart_poll(void)
+{
+	if (uart != NULL && (uart->IntrMask & XUARTPS_IXR_RXOVR) && _rx_ready(uart)) {
+		sim_irq_raise(XPAR_XUARTPS_0_INTR);
+	}
+}
@@ -0,0 +1,335 @@
+#!/usr/bin/env python3
+"""Decode an AMDC binary log dump into CSV or binary files.
+
+Capture the serial console output of 'log dump bin all' (or
+'log dump bin <log_var_idx>') to a file (binary-safe, e.g. with your
+terminal's raw logging), then run:
+
+    python3 log2csv.py capture.bin out_dir
+    python3 log2csv.py --format bin capture.bin out_dir
+
+One file is written per logged variable, named after the variable:
+
+  csv -- '<name>.csv' with a 'timestamp_usec,value' header row
+  bin -- '<name>.bin' of packed little-endian records, each a uint32
+         timestamp in usec followed by a float64 value
+
+Variables logged with 'log decim <idx> env' get 'mean,min,max' columns
+(three float64 values per record) instead of 'value'.
+
+The log group ('log group ...') is written to 'group.csv' with a
+'timestamp_usec,seq,<channel>,...' header row, or to 'group.bin' with
+records of a uint32 timestamp, a uint32 sequence number and one float64
+per channel.
+
+A streamed log ('log stream ...') is written to 'stream.csv' / 'stream.bin'
+in the same layout as the group; later streams in the same capture go to
+'stream_1.csv' and so on. Rows dropped on the target (ring full) show up
+as gaps in 'seq' and are counted in the summary.
+
+Frames whose CRC does not match (dropped or corrupted bytes) are
+reported and skipped.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+# Must match log_frame_header_t, log_group_header_t and var_type_e in sdk/bare/sys/log.h
+MAGIC = b'AMDL'
+GROUP_MAGIC = b'AMDG'
+STREAM_MAGIC = b'AMDS'
+VERSION = 2
+HEADER = struct.Struct('<4sBBBBII16s')
+GROUP_HEADER = struct.Struct('<4sBBHII')
+GROUP_CHANNEL = struct.Struct('<16sBBH')
+STREAM_HEADER = struct.Struct('<4sBBBBIIIHH')
+STREAM_DESCRIPTOR = 0x01
+CRC = struct.Struct('<I')
+
+FRAME_START = re.compile(b'|'.join(re.escape(m) for m in (MAGIC, GROUP_MAGIC, STREAM_MAGIC)))
+
+# var_type_e -> struct format of one value
+TYPES = {
+    1: 'i',   # INT (int32)
+    2: 'f',   # FLOAT
+    3: 'd',   # DOUBLE
+    4: 'b',   # INT8
+    5: 'B',   # UINT8
+    6: 'h',   # INT16
+    7: 'H',   # UINT16
+    8: 'I',   # UINT32
+    9: 'q',   # INT64
+    10: 'Q',  # UINT64
+}
+
+# Must match log_decim_e
+DECIM_ENVELOPE = 4
+
+
+def parse_frames(data):
+    """Yield (header dict, timestamps, columns) for each valid frame.
+
+    columns maps a column name to its list of values: just 'value' for
+    a variable, or 'seq' and one entry per channel for the group.
+    """
+    stream_channels = None
+
+    m = FRAME_START.search(data)
+    while m is not None:
+        pos = m.start()
+        if m.group() == MAGIC:
+            frame = _parse_var(data, pos)
+        elif m.group() == GROUP_MAGIC:
+            frame = _parse_group(data, pos)
+        else:
+            frame = _parse_stream(data, pos, stream_channels)
+
+        if frame is None:
+            m = FRAME_START.search(data, pos + 1)
+            continue
+
+        header, timestamps, columns, end = frame
+        if header is None:
+            pass
+        elif 'channels' in header:
+            # Stream descriptor: no rows, just how to decode them
+            stream_channels = header['channels']
+            if header['packet_seq'] == 0:
+                # First packet of a new stream
+                yield {'name': 'stream', 'start': True}, None, None
+        else:
+            yield header, timestamps, columns
+        m = FRAME_START.search(data, end)
+
+
+def _check(data, pos, body):
+    """Returns the end of the frame if its CRC matches, else None."""
+    end = pos + body + CRC.size
+    if end > len(data):
+        sys.stderr.write('log2csv: frame at offset %d truncated\n' % pos)
+        return None
+
+    (crc,) = CRC.unpack_from(data, pos + body)
+    if zlib.crc32(data[pos:pos + body]) & 0xFFFFFFFF != crc:
+        sys.stderr.write('log2csv: frame at offset %d has bad CRC, skipped\n' % pos)
+        return None
+    return end
+
+
+def _width(vtype):
+    return struct.calcsize(TYPES[vtype])
+
+
+def _values(data, off, vtype, n):
+    return struct.unpack_from('<%d%s' % (n, TYPES[vtype]), data, off)
+
+
+def _name(raw):
+    return raw.split(b'\0', 1)[0].decode('ascii', 'replace')
+
+
+def _parse_var(data, pos):
+    if pos + HEADER.size > len(data):
+        return None
+
+    magic, version, var_idx, vtype, decim, num_samples, interval_usec, name = HEADER.unpack_from(data, pos)
+    if version != VERSION or vtype not in TYPES:
+        return None
+
+    names = ['mean', 'min', 'max'] if decim == DECIM_ENVELOPE else ['value']
+    width = _width(vtype)
+
+    end = _check(data, pos, HEADER.size + num_samples * (4 + width * len(names)))
+    if end is None:
+        return None
+
+    off = pos + HEADER.size
+    timestamps = struct.unpack_from('<%dI' % num_samples, data, off)
+    columns = {}
+    for i, col in enumerate(names):
+        columns[col] = _values(data, off + num_samples * (4 + width * i), vtype, num_samples)
+
+    header = {
+        'var_idx': var_idx,
+        'num_samples': num_samples,
+        'interval_usec': interval_usec,
+        'name': _name(name) or 'var%d' % var_idx,
+    }
+    return header, timestamps, columns, end
+
+
+def _parse_group(data, pos):
+    if pos + GROUP_HEADER.size > len(data):
+        return None
+
+    magic, version, num_channels, _, num_samples, interval_usec = GROUP_HEADER.unpack_from(data, pos)
+    if version != VERSION or num_channels == 0:
+        return None
+
+    chans_size = num_channels * GROUP_CHANNEL.size
+    if pos + GROUP_HEADER.size + chans_size > len(data):
+        return None
+
+    channels = []
+    for c in range(num_channels):
+        name, var_idx, vtype, _ = GROUP_CHANNEL.unpack_from(data, pos + GROUP_HEADER.size + c * GROUP_CHANNEL.size)
+        if vtype not in TYPES:
+            return None
+        channels.append((_name(name) or 'var%d' % var_idx, vtype))
+
+    off = pos + GROUP_HEADER.size + chans_size
+    row_size = 8 + sum(_width(vtype) for _, vtype in channels)
+    end = _check(data, pos, (off - pos) + num_samples * row_size)
+    if end is None:
+        return None
+
+    timestamps = struct.unpack_from('<%dI' % num_samples, data, off)
+    columns = {'seq': struct.unpack_from('<%dI' % num_samples, data, off + 4 * num_samples)}
+    off += 8 * num_samples
+    for name, vtype in channels:
+        columns[name] = _values(data, off, vtype, num_samples)
+        off += _width(vtype) * num_samples
+
+    header = {
+        'num_samples': num_samples,
+        'interval_usec': interval_usec,
+        'name': 'group',
+    }
+    return header, timestamps, columns, end
+
+
+def _parse_stream(data, pos, channels):
+    if pos + STREAM_HEADER.size > len(data):
+        return None
+
+    (magic, version, flags, num_channels, _, packet_seq, dropped,
+     interval_usec, num_rows, clamp) = STREAM_HEADER.unpack_from(data, pos)
+    if version != VERSION or num_channels == 0:
+        return None
+
+    off = pos + STREAM_HEADER.size
+
+    if flags & STREAM_DESCRIPTOR:
+        end = _check(data, pos, STREAM_HEADER.size + num_channels * GROUP_CHANNEL.size)
+        if end is None:
+            return None
+
+        chans = []
+        for c in range(num_channels):
+            name, var_idx, vtype, _ = GROUP_CHANNEL.unpack_from(data, off + c * GROUP_CHANNEL.size)
+            if vtype not in TYPES:
+                return None
+            name = _name(name) or 'var%d' % var_idx
+            # The same variable may be streamed twice
+            if name in (n for n, _ in chans):
+                name = '%s_%d' % (name, c)
+            chans.append((name, vtype))
+        return {'channels': chans, 'packet_seq': packet_seq}, None, None, end
+
+    if channels is None or len(channels) != num_channels:
+        # Row size is unknown, so the CRC can't be checked either
+        sys.stderr.write('log2csv: stream packet at offset %d before its descriptor, skipped\n' % pos)
+        return None
+
+    # Values are packed at their own width, rows padded to 4 bytes
+    fmt = '<II' + ''.join(TYPES[vtype] for _, vtype in channels)
+    row = struct.Struct(fmt + 'x' * (-struct.calcsize(fmt) % 4))
+
+    end = _check(data, pos, STREAM_HEADER.size + row.size * num_rows)
+    if end is None:
+        return None
+
+    rows = list(row.iter_unpack(data[off:off + row.size * num_rows]))
+    timestamps = [r[1] for r in rows]
+    columns = {'seq': [r[0] for r in rows]}
+    for c, (name, vtype) in enumerate(channels):
+        columns[name] = [r[2 + c] for r in rows]
+
+    header = {
+        'num_samples': num_rows,
+        'interval_usec': interval_usec,
+        'name': 'stream',
+        'packet_seq': packet_seq,
+        'dropped': dropped,
+    }
+    return header, timestamps, columns, end
+
+
+def write_csv(path, timestamps, columns):
+    with open(path, 'w') as f:
+        f.write(','.join(['timestamp_usec'] + list(columns)) + '\n')
+        for row in zip(timestamps, *columns.values()):
+            f.write('%d,' % row[0] + ','.join('%r' % v for v in row[1:]) + '\n')
+
+
+def write_bin(path, timestamps, columns):
+    names = list(columns)
+    fmt = '<I' + ''.join('I' if n == 'seq' else 'd' for n in names)
+    rec = struct.Struct(fmt)
+    with open(path, 'wb') as f:
+        for row in zip(timestamps, *columns.values()):
+            f.write(rec.pack(*row))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--format', choices=('csv', 'bin'), default='csv')
+    parser.add_argument('capture', help='raw serial capture')
+    parser.add_argument('out_dir', help='directory to write files into')
+    args = parser.parse_args()
+
+    with open(args.capture, 'rb') as f:
+        data = f.read()
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    writer = write_csv if args.format == 'csv' else write_bin
+
+    count = 0
+    streams = []
+    for header, timestamps, columns in parse_frames(data):
+        name = header['name']
+
+        if name == 'stream':
+            # Packets of one stream are joined into one file
+            if header.get('start'):
+                streams.append(None)
+                continue
+            if not streams or streams[-1] is None or list(streams[-1][1]) != list(columns):
+                if streams and streams[-1] is None:
+                    streams.pop()
+                streams.append(([], {k: [] for k in columns}, header))
+            stream = streams[-1]
+            stream[0].extend(timestamps)
+            for k, v in columns.items():
+                stream[1][k].extend(v)
+            stream[2]['dropped'] = header['dropped']
+            continue
+
+        path = os.path.join(args.out_dir, '%s.%s' % (name, args.format))
+        writer(path, timestamps, columns)
+        print('%s: %d samples -> %s' % (name, header['num_samples'], path))
+        count += 1
+
+    streams = [s for s in streams if s is not None]
+    for i, (timestamps, columns, header) in enumerate(streams):
+        seqs = columns['seq']
+        missing = seqs[-1] - seqs[0] + 1 - len(seqs)
+        name = 'stream' if i == 0 else 'stream_%d' % i
+        path = os.path.join(args.out_dir, '%s.%s' % (name, args.format))
+        writer(path, timestamps, columns)
+        print('%s: %d samples, %d missing (%d dropped on target) -> %s'
+              % (name, len(seqs), missing, header['dropped'], path))
+        count += 1
+
+    if count == 0:
+        sys.stderr.write('log2csv: no log frames found\n')
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
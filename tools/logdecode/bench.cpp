@@ -0,0 +1,214 @@
+// Benchmarks decoding and exporting of large captures
+//
+//   logdecode_bench [-s MB]
+//
+// Synthesizes captures of about the given size (default 256 MB) in
+// memory: an 'LFS' stream of the basic firmware's 14 logs, a bare
+// 'log stream' of 8 channels and a bare text dump. Reports throughput
+// of decoding each, then of writing the decoded tables as CSV and as
+// columnar files, in MB/s of capture.
+
+#include "logdecode.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+using namespace amdc;
+
+namespace {
+
+const int LFR_NUM_LOGS = 14;
+const uint32_t LFR_WORDS_PER_PACKET = 1024;
+const int STREAM_NUM_CHANNELS = 8;
+const uint16_t STREAM_ROWS_PER_PACKET = 64;
+
+#ifdef _WIN32
+const char *NULL_DEVICE = "NUL";
+#else
+const char *NULL_DEVICE = "/dev/null";
+#endif
+
+double now_sec()
+{
+	using clock = std::chrono::steady_clock;
+	return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+void put_u32(std::string &s, uint32_t x)
+{
+	s.append((const char *) &x, sizeof(x));
+}
+
+void put_crc(std::string &s, size_t start)
+{
+	put_u32(s, crc32_update(0, s.data() + start, s.size() - start));
+}
+
+// Same framing as the basic firmware's 'LFS' replies
+std::string make_lfr(size_t bytes)
+{
+	std::string s;
+	s.reserve(bytes + 4096);
+
+	uint32_t sqn = 1;
+	uint32_t sample = 0;
+	std::vector<uint32_t> words(LFR_WORDS_PER_PACKET);
+
+	while (s.size() < bytes) {
+		for (int idx = 0; idx < LFR_NUM_LOGS; idx++) {
+			for (uint32_t i = 0; i < LFR_WORDS_PER_PACKET; i++) {
+				float x = (float) std::sin((sample + i) * 0.001 + idx);
+				std::memcpy(&words[i], &x, sizeof(x));
+			}
+
+			s += "\n\rLFR=" + std::to_string(sqn++) + "," + std::to_string(idx) + ",0,"
+					+ std::to_string(LFR_WORDS_PER_PACKET * 4) + ",";
+			s.append((const char *) words.data(), words.size() * 4);
+			s += "\n\r";
+		}
+		sample += LFR_WORDS_PER_PACKET;
+	}
+
+	return s;
+}
+
+// Same layout as 'log stream' packets, see sdk/bare/sys/log_stream.c
+std::string make_stream(size_t bytes)
+{
+	std::string s;
+	s.reserve(bytes + 4096);
+
+	auto header = [&](uint8_t flags, uint32_t packet_seq, uint16_t num_rows) {
+		put_u32(s, 0x53444D41);
+		s += (char) 2;
+		s += (char) flags;
+		s += (char) STREAM_NUM_CHANNELS;
+		s += (char) 0;
+		put_u32(s, packet_seq);
+		put_u32(s, 0);
+		put_u32(s, 100);
+		s.append((const char *) &num_rows, 2);
+		s.append(2, '\0');
+	};
+
+	header(1, 0, 0);
+	for (int c = 0; c < STREAM_NUM_CHANNELS; c++) {
+		char name[16] = {0};
+		std::snprintf(name, sizeof(name), "chan%d", c);
+		s.append(name, sizeof(name));
+		s += (char) c;
+		s += (char) 2;	// float
+		s.append(2, '\0');
+	}
+	put_crc(s, 0);
+
+	uint32_t seq = 0;
+	for (uint32_t packet = 1; s.size() < bytes; packet++) {
+		size_t start = s.size();
+		header(0, packet, STREAM_ROWS_PER_PACKET);
+
+		for (int r = 0; r < STREAM_ROWS_PER_PACKET; r++, seq++) {
+			put_u32(s, seq);
+			put_u32(s, seq * 100);
+			for (int c = 0; c < STREAM_NUM_CHANNELS; c++) {
+				float x = (float) std::sin(seq * 0.001 + c);
+				s.append((const char *) &x, sizeof(x));
+			}
+		}
+		put_crc(s, start);
+	}
+
+	return s;
+}
+
+// Same lines as 'log dump <idx>', see sdk/bare/sys/log.c
+std::string make_text(size_t bytes)
+{
+	std::string s;
+	s.reserve(bytes + 4096);
+
+	// Sample count is only known at the end
+	s += "LOG OF VARIABLE: 'Iabc_a'\r\nNUM SAMPLES: 0\r\n-------START-------\r\n";
+
+	char line[64];
+	for (uint32_t i = 0; s.size() < bytes; i++) {
+		int n = std::snprintf(line, sizeof(line), "> %ld\t\t%f\r\n",
+				(long) (int32_t) (i * 100), std::sin(i * 0.001));
+		s.append(line, n);
+	}
+
+	s += "-------END-------\r\n\r\n";
+	return s;
+}
+
+void report(const char *what, size_t bytes, double sec)
+{
+	std::printf("  %-10s %8.3f s  %8.1f MB/s\n", what, sec, bytes / sec / 1e6);
+}
+
+void run(const char *name, const std::string &capture)
+{
+	std::printf("%s: %.1f MB\n", name, capture.size() / 1e6);
+
+	double t0 = now_sec();
+	capture_t cap = decode_capture((const uint8_t *) capture.data(), capture.size());
+	report("decode", capture.size(), now_sec() - t0);
+
+	size_t rows = 0;
+	for (const table_t &t : cap.tables) {
+		rows += t.num_rows();
+	}
+
+	std::FILE *f = std::fopen(NULL_DEVICE, "wb");
+	if (f == nullptr) {
+		std::fprintf(stderr, "logdecode_bench: can't open %s\n", NULL_DEVICE);
+		std::exit(1);
+	}
+
+	t0 = now_sec();
+	for (const table_t &t : cap.tables) {
+		write_csv(t, f);
+	}
+	report("csv", capture.size(), now_sec() - t0);
+	std::fclose(f);
+
+	std::filesystem::path dir = std::filesystem::temp_directory_path() / "logdecode_bench";
+
+	t0 = now_sec();
+	for (const table_t &t : cap.tables) {
+		write_columnar(t, (dir / t.name).string());
+	}
+	report("columnar", capture.size(), now_sec() - t0);
+
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+
+	std::printf("  %zu tables, %zu rows, %zu warnings\n", cap.tables.size(), rows, cap.warnings.size());
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	size_t mb = 256;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+			mb = std::strtoul(argv[++i], nullptr, 10);
+		} else {
+			std::fprintf(stderr, "usage: logdecode_bench [-s MB]\n");
+			return 1;
+		}
+	}
+
+	size_t bytes = mb << 20;
+
+	run("lfr", make_lfr(bytes));
+	run("stream", make_stream(bytes));
+	run("text", make_text(bytes));
+
+	return 0;
+}
@@ -0,0 +1,939 @@
+#include "logdecode.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <string_view>
+
+namespace amdc {
+
+namespace {
+
+// Must match sdk/bare/sys/log.h and log_stream.h. Fields are read
+// at these offsets, little-endian like the firmware and any PC
+const uint32_t FRAME_MAGIC = 0x4C444D41;	// "AMDL"
+const uint32_t GROUP_MAGIC = 0x47444D41;	// "AMDG"
+const uint32_t STREAM_MAGIC = 0x53444D41;	// "AMDS"
+const uint8_t FRAME_VERSION = 2;
+const uint8_t STREAM_VERSION = 2;
+const uint8_t STREAM_DESCRIPTOR = 0x01;
+const uint8_t DECIM_ENVELOPE = 4;
+
+const size_t NAME_CHARS = 16;
+const size_t FRAME_HEADER_BYTES = 16 + NAME_CHARS;
+const size_t GROUP_HEADER_BYTES = 16;
+const size_t GROUP_CHANNEL_BYTES = NAME_CHARS + 4;
+const size_t STREAM_HEADER_BYTES = 24;
+const size_t CRC_BYTES = 4;
+
+// LFR payloads are read out of 400 KB logs
+const uint32_t LFR_MAX_BYTES = 1u << 24;
+const int LFR_MAX_LOGS = 256;
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+uint32_t get_u32(const uint8_t *p)
+{
+	uint32_t x;
+	std::memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+uint16_t get_u16(const uint8_t *p)
+{
+	uint16_t x;
+	std::memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+// Bytes per value of var_type_e, 0 if unknown
+size_t type_width(uint8_t type)
+{
+	static const uint8_t widths[] = {0, 4, 4, 8, 1, 1, 2, 2, 4, 8, 8};
+	return (type < sizeof(widths)) ? widths[type] : 0;
+}
+
+template <typename T>
+void append_as(std::vector<double> &dst, const uint8_t *src, size_t n, size_t stride)
+{
+	size_t base = dst.size();
+	dst.resize(base + n);
+
+	for (size_t i = 0; i < n; i++) {
+		T x;
+		std::memcpy(&x, src + i * stride, sizeof(x));
+		dst[base + i] = (double) x;
+	}
+}
+
+// Appends 'n' values of var_type_e 'type', 'stride' bytes apart
+void append_values(std::vector<double> &dst, uint8_t type, const uint8_t *src, size_t n, size_t stride)
+{
+	switch (type) {
+	case 1: append_as<int32_t>(dst, src, n, stride); break;
+	case 2: append_as<float>(dst, src, n, stride); break;
+	case 3: append_as<double>(dst, src, n, stride); break;
+	case 4: append_as<int8_t>(dst, src, n, stride); break;
+	case 5: append_as<uint8_t>(dst, src, n, stride); break;
+	case 6: append_as<int16_t>(dst, src, n, stride); break;
+	case 7: append_as<uint16_t>(dst, src, n, stride); break;
+	case 8: append_as<uint32_t>(dst, src, n, stride); break;
+	case 9: append_as<int64_t>(dst, src, n, stride); break;
+	case 10: append_as<uint64_t>(dst, src, n, stride); break;
+	default: break;
+	}
+}
+
+std::string frame_name(const uint8_t *p, int idx)
+{
+	size_t n = strnlen((const char *) p, NAME_CHARS);
+	return n ? std::string((const char *) p, n) : "var" + std::to_string(idx);
+}
+
+// Firmware timestamps are 32-bit microseconds, which wrap every
+// 71 minutes; assumes rows are in time order
+typedef struct unwrap_t {
+	uint64_t epoch = 0;
+	uint32_t last = 0;
+
+	uint64_t operator()(uint32_t t)
+	{
+		if (t < last) {
+			epoch += 1ull << 32;
+		}
+		last = t;
+		return epoch + t;
+	}
+} unwrap_t;
+
+typedef struct channel_t {
+	std::string name;
+	uint8_t type;
+} channel_t;
+
+typedef struct lfr_log_t {
+	std::vector<uint32_t> words;
+	bool overrun = false;
+} lfr_log_t;
+
+class decoder_t {
+public:
+	decoder_t(const uint8_t *data, size_t len, const lfr_options_t &lfr, capture_t &cap)
+		: data(data), len(len), lfr(lfr), cap(cap)
+	{
+	}
+
+	void run();
+
+private:
+	size_t parse_text(size_t pos);
+	size_t parse_var(size_t pos);
+	size_t parse_group(size_t pos);
+	size_t parse_stream(size_t pos);
+	size_t parse_lfr(size_t pos);
+	void finish_lfr();
+
+	bool check_crc(size_t pos, size_t body);
+	size_t new_table(const std::string &name);
+	void warn(const std::string &msg) { cap.warnings.push_back(msg); }
+
+	const uint8_t *data;
+	size_t len;
+	const lfr_options_t &lfr;
+	capture_t &cap;
+
+	std::map<std::string, int> name_counts;
+
+	// Stream being joined from its packets
+	std::vector<channel_t> stream_channels;
+	bool stream_restart = false;
+	size_t stream_table = SIZE_MAX;
+	unwrap_t stream_clock;
+	uint32_t stream_last_seq = 0;
+
+	// LFR session being reassembled
+	std::map<int, lfr_log_t> lfr_logs;
+	size_t lfr_table = SIZE_MAX;
+	int64_t lfr_last_sqn = -1;
+};
+
+size_t decoder_t::new_table(const std::string &name)
+{
+	// Same variable dumped twice, or a second stream
+	int n = name_counts[name]++;
+
+	table_t t;
+	t.name = n ? name + "_" + std::to_string(n) : name;
+	cap.tables.push_back(std::move(t));
+
+	return cap.tables.size() - 1;
+}
+
+bool decoder_t::check_crc(size_t pos, size_t body)
+{
+	if (body > len - pos || CRC_BYTES > len - pos - body) {
+		warn("frame at offset " + std::to_string(pos) + " truncated");
+		cap.bad_frames++;
+		return false;
+	}
+
+	if (crc32_update(0, data + pos, body) != get_u32(data + pos + body)) {
+		warn("frame at offset " + std::to_string(pos) + " has bad CRC, skipped");
+		cap.bad_frames++;
+		return false;
+	}
+
+	cap.frames++;
+	return true;
+}
+
+// Returns the end of the frame, or 0 if there is none at 'pos'
+size_t decoder_t::parse_var(size_t pos)
+{
+	if (len - pos < FRAME_HEADER_BYTES) {
+		return 0;
+	}
+
+	const uint8_t *h = data + pos;
+	uint8_t var_idx = h[5];
+	uint8_t type = h[6];
+	uint8_t decim = h[7];
+	uint32_t num_samples = get_u32(h + 8);
+	size_t width = type_width(type);
+
+	if (h[4] != FRAME_VERSION || width == 0) {
+		return 0;
+	}
+
+	int num_arrays = (decim == DECIM_ENVELOPE) ? 3 : 1;
+	uint64_t body = FRAME_HEADER_BYTES + (uint64_t) num_samples * (4 + width * num_arrays);
+	if (body > len || !check_crc(pos, body)) {
+		return 0;
+	}
+
+	table_t &t = cap.tables[new_table(frame_name(h + 16, var_idx))];
+	const uint8_t *p = h + FRAME_HEADER_BYTES;
+
+	unwrap_t clock;
+	t.time_usec.resize(num_samples);
+	for (uint32_t i = 0; i < num_samples; i++) {
+		t.time_usec[i] = clock(get_u32(p + 4 * i));
+	}
+	p += 4 * (size_t) num_samples;
+
+	if (num_arrays == 3) {
+		t.column_names = {"mean", "min", "max"};
+	} else {
+		t.column_names = {"value"};
+	}
+
+	t.columns.resize(num_arrays);
+	for (int a = 0; a < num_arrays; a++) {
+		append_values(t.columns[a], type, p, num_samples, width);
+		p += width * num_samples;
+	}
+
+	return pos + body + CRC_BYTES;
+}
+
+size_t decoder_t::parse_group(size_t pos)
+{
+	if (len - pos < GROUP_HEADER_BYTES) {
+		return 0;
+	}
+
+	const uint8_t *h = data + pos;
+	uint8_t num_channels = h[5];
+	uint32_t num_samples = get_u32(h + 8);
+
+	if (h[4] != FRAME_VERSION || num_channels == 0) {
+		return 0;
+	}
+
+	size_t chans_bytes = num_channels * GROUP_CHANNEL_BYTES;
+	if (len - pos < GROUP_HEADER_BYTES + chans_bytes) {
+		return 0;
+	}
+
+	std::vector<channel_t> chans;
+	uint64_t row_bytes = 8;
+	for (int c = 0; c < num_channels; c++) {
+		const uint8_t *ch = h + GROUP_HEADER_BYTES + c * GROUP_CHANNEL_BYTES;
+		if (type_width(ch[NAME_CHARS + 1]) == 0) {
+			return 0;
+		}
+
+		chans.push_back({frame_name(ch, ch[NAME_CHARS]), ch[NAME_CHARS + 1]});
+		row_bytes += type_width(chans.back().type);
+	}
+
+	uint64_t body = GROUP_HEADER_BYTES + chans_bytes + num_samples * row_bytes;
+	if (body > len || !check_crc(pos, body)) {
+		return 0;
+	}
+
+	table_t &t = cap.tables[new_table("group")];
+	const uint8_t *p = h + GROUP_HEADER_BYTES + chans_bytes;
+
+	unwrap_t clock;
+	t.time_usec.resize(num_samples);
+	t.seq.resize(num_samples);
+	for (uint32_t i = 0; i < num_samples; i++) {
+		t.time_usec[i] = clock(get_u32(p + 4 * i));
+		t.seq[i] = get_u32(p + 4 * (num_samples + i));
+
+		if (i > 0 && t.seq[i] - t.seq[i - 1] > 1) {
+			t.missing += t.seq[i] - t.seq[i - 1] - 1;
+		}
+	}
+	p += 8 * (size_t) num_samples;
+
+	t.columns.resize(num_channels);
+	for (int c = 0; c < num_channels; c++) {
+		size_t width = type_width(chans[c].type);
+		t.column_names.push_back(chans[c].name);
+		append_values(t.columns[c], chans[c].type, p, num_samples, width);
+		p += width * num_samples;
+	}
+
+	return pos + body + CRC_BYTES;
+}
+
+size_t decoder_t::parse_stream(size_t pos)
+{
+	if (len - pos < STREAM_HEADER_BYTES) {
+		return 0;
+	}
+
+	const uint8_t *h = data + pos;
+	uint8_t flags = h[5];
+	uint8_t num_channels = h[6];
+	uint32_t packet_seq = get_u32(h + 8);
+	uint32_t dropped = get_u32(h + 12);
+	uint16_t num_rows = get_u16(h + 20);
+
+	if (h[4] != STREAM_VERSION || num_channels == 0) {
+		return 0;
+	}
+
+	const uint8_t *p = h + STREAM_HEADER_BYTES;
+
+	if (flags & STREAM_DESCRIPTOR) {
+		size_t body = STREAM_HEADER_BYTES + num_channels * GROUP_CHANNEL_BYTES;
+		if (body > len - pos || !check_crc(pos, body)) {
+			return 0;
+		}
+
+		std::vector<channel_t> chans;
+		for (int c = 0; c < num_channels; c++) {
+			const uint8_t *ch = p + c * GROUP_CHANNEL_BYTES;
+			std::string name = frame_name(ch, ch[NAME_CHARS]);
+
+			// The same variable may be streamed twice
+			for (const channel_t &other : chans) {
+				if (other.name == name) {
+					name += "_" + std::to_string(c);
+					break;
+				}
+			}
+			chans.push_back({name, ch[NAME_CHARS + 1]});
+		}
+
+		stream_channels = chans;
+
+		// First packet of a new stream
+		if (packet_seq == 0) {
+			stream_restart = true;
+		}
+		return pos + body + CRC_BYTES;
+	}
+
+	if (stream_channels.size() != num_channels) {
+		// Row size is unknown, so the CRC can't be checked either
+		warn("stream packet at offset " + std::to_string(pos) + " before its descriptor, skipped");
+		return 0;
+	}
+
+	// Values are packed at their own width, rows padded to 4 bytes
+	size_t row_bytes = 8;
+	for (const channel_t &ch : stream_channels) {
+		row_bytes += type_width(ch.type);
+	}
+	row_bytes = (row_bytes + 3) & ~(size_t) 3;
+
+	size_t body = STREAM_HEADER_BYTES + num_rows * row_bytes;
+	if (body > len - pos || !check_crc(pos, body)) {
+		return 0;
+	}
+
+	if (stream_table == SIZE_MAX || stream_restart) {
+		stream_restart = false;
+		stream_table = new_table("stream");
+		stream_clock = unwrap_t();
+
+		table_t &t = cap.tables[stream_table];
+		for (const channel_t &ch : stream_channels) {
+			t.column_names.push_back(ch.name);
+		}
+		t.columns.resize(num_channels);
+	} else if (num_rows > 0 && !cap.tables[stream_table].seq.empty()) {
+		// Rows lost between packets
+		uint32_t gap = get_u32(p) - stream_last_seq;
+		if (gap > 1) {
+			cap.tables[stream_table].missing += gap - 1;
+		}
+	}
+
+	table_t &t = cap.tables[stream_table];
+	t.dropped = dropped;
+
+	for (uint16_t r = 0; r < num_rows; r++) {
+		const uint8_t *row = p + r * row_bytes;
+		uint32_t seq = get_u32(row);
+
+		if (r > 0 && seq - stream_last_seq > 1) {
+			t.missing += seq - stream_last_seq - 1;
+		}
+
+		t.seq.push_back(seq);
+		t.time_usec.push_back(stream_clock(get_u32(row + 4)));
+		stream_last_seq = seq;
+	}
+
+	size_t offset = 8;
+	for (int c = 0; c < num_channels; c++) {
+		append_values(t.columns[c], stream_channels[c].type, p + offset, num_rows, row_bytes);
+		offset += type_width(stream_channels[c].type);
+	}
+
+	return pos + body + CRC_BYTES;
+}
+
+// Reads a decimal number ending in 'sep'
+template <typename T>
+bool parse_field(const char *&p, const char *end, char sep, T &value)
+{
+	auto r = std::from_chars(p, end, value);
+	if (r.ec != std::errc() || r.ptr == end || *r.ptr != sep) {
+		return false;
+	}
+
+	p = r.ptr + 1;
+	return true;
+}
+
+// LFR=sqn,idx,flags,len,<len bytes: raw 32-bit words of log idx>
+size_t decoder_t::parse_lfr(size_t pos)
+{
+	const char *start = (const char *) data + pos + 4;
+	const char *end = (const char *) data + len;
+	const char *p = start;
+
+	int64_t sqn;
+	int idx;
+	uint32_t flags;
+	uint32_t bytes;
+
+	if (!parse_field(p, end, ',', sqn) || !parse_field(p, end, ',', idx)
+			|| !parse_field(p, end, ',', flags) || !parse_field(p, end, ',', bytes)) {
+		return 0;
+	}
+
+	if (idx < 0 || idx >= LFR_MAX_LOGS || bytes % 4 != 0 || bytes > LFR_MAX_BYTES
+			|| bytes > (size_t) (end - p)) {
+		return 0;
+	}
+
+	cap.lfr_packets++;
+
+	// Polled 'LFR' replies always carry 1; 'LFS' restarts counting at 1
+	if (sqn == 1 && lfr_last_sqn > 1) {
+		finish_lfr();
+	} else if (lfr_last_sqn >= 0 && sqn > lfr_last_sqn + 1) {
+		// The packet's log is unknown, so from here on that log's
+		// samples land in earlier rows than they were taken in
+		uint64_t lost = sqn - lfr_last_sqn - 1;
+		cap.lfr_lost_packets += lost;
+		warn("LFR packets " + std::to_string(lfr_last_sqn + 1) + ".." + std::to_string(sqn - 1)
+				+ " missing, rows after the gap may be misaligned");
+	}
+	lfr_last_sqn = sqn;
+
+	if (lfr_table == SIZE_MAX) {
+		lfr_table = new_table("lfr");
+	}
+
+	lfr_log_t &log = lfr_logs[idx];
+	size_t n = log.words.size();
+	log.words.resize(n + bytes / 4);
+	std::memcpy(&log.words[n], p, bytes);
+
+	// FIFO_OVERRUN_OCCURED: the target skipped samples of this log
+	if ((flags & 1) && !log.overrun) {
+		log.overrun = true;
+		warn("LFR log " + std::to_string(idx) + " overran on the target, its later rows may be misaligned");
+	}
+
+	return (p - (const char *) data) + bytes;
+}
+
+// Lines up the logs of an LFR session by sample number: every log
+// takes one sample in each DoLogging() call
+void decoder_t::finish_lfr()
+{
+	if (lfr_table == SIZE_MAX) {
+		return;
+	}
+
+	table_t &t = cap.tables[lfr_table];
+
+	// Logs stop unevenly, so shorter ones are padded with NaN
+	size_t rows = 0;
+	for (auto &kv : lfr_logs) {
+		rows = std::max(rows, kv.second.words.size());
+	}
+
+	t.time_usec.resize(rows);
+	for (size_t i = 0; i < rows; i++) {
+		t.time_usec[i] = (uint64_t) i * lfr.period_usec;
+	}
+
+	for (auto &kv : lfr_logs) {
+		int idx = kv.first;
+		const std::vector<uint32_t> &words = kv.second.words;
+
+		auto name = lfr.names.find(idx);
+		t.column_names.push_back(name != lfr.names.end() ? name->second : "log" + std::to_string(idx));
+
+		auto type = lfr.types.find(idx);
+		word_type_e wt = (type != lfr.types.end()) ? type->second : WORD_UINT32;
+
+		std::vector<double> col;
+		col.reserve(rows);
+		append_values(col, (wt == WORD_FLOAT) ? 2 : (wt == WORD_INT32) ? 1 : 8,
+				(const uint8_t *) words.data(), words.size(), sizeof(uint32_t));
+		col.resize(rows, NaN);
+
+		t.columns.push_back(std::move(col));
+	}
+
+	lfr_logs.clear();
+	lfr_table = SIZE_MAX;
+	lfr_last_sqn = -1;
+}
+
+typedef struct line_t {
+	std::string_view text;
+	size_t next;
+} line_t;
+
+// Text dumps end lines with "\r\n"; "\n" alone is accepted too
+line_t next_line(const uint8_t *data, size_t len, size_t pos)
+{
+	const uint8_t *nl = (const uint8_t *) std::memchr(data + pos, '\n', len - pos);
+	size_t end = nl ? (size_t) (nl - data) : len;
+	size_t next = nl ? end + 1 : len;
+
+	if (end > pos && data[end - 1] == '\r') {
+		end--;
+	}
+
+	return {std::string_view((const char *) data + pos, end - pos), next};
+}
+
+bool starts_with(std::string_view s, std::string_view prefix)
+{
+	return s.substr(0, prefix.size()) == prefix;
+}
+
+// Parses "> <timestamp>\t\t<value>[\t<min>\t<max>]"
+int parse_sample(std::string_view s, int64_t &timestamp, double values[3])
+{
+	if (!starts_with(s, "> ")) {
+		return 0;
+	}
+
+	const char *p = s.data() + 2;
+	const char *end = s.data() + s.size();
+
+	auto r = std::from_chars(p, end, timestamp);
+	if (r.ec != std::errc()) {
+		return 0;
+	}
+	p = r.ptr;
+
+	int n = 0;
+	while (p < end && n < 3) {
+		while (p < end && (*p == '\t' || *p == ' ')) {
+			p++;
+		}
+		if (p == end) {
+			break;
+		}
+
+		auto v = std::from_chars(p, end, values[n]);
+		if (v.ec != std::errc() && v.ec != std::errc::result_out_of_range) {
+			return 0;
+		}
+		p = v.ptr;
+		n++;
+	}
+
+	return (p == end && (n == 1 || n == 3)) ? n : 0;
+}
+
+// 'log dump <idx>' text:
+//
+//   LOG OF VARIABLE: '<name>'
+//   NUM SAMPLES: <n>
+//   -------START-------
+//   > <timestamp>\t\t<value>[\t<min>\t<max>]
+//   -------END-------
+//
+size_t decoder_t::parse_text(size_t pos)
+{
+	line_t title = next_line(data, len, pos);
+	std::string_view s = title.text.substr(18);
+	size_t quote = s.find('\'');
+	if (quote == std::string_view::npos) {
+		return 0;
+	}
+	std::string name(s.substr(0, quote));
+
+	line_t count = next_line(data, len, title.next);
+	line_t start = next_line(data, len, count.next);
+	uint64_t num_samples = 0;
+
+	if (!starts_with(count.text, "NUM SAMPLES: ") || start.text != "-------START-------") {
+		return 0;
+	}
+	std::from_chars(count.text.data() + 13, count.text.data() + count.text.size(), num_samples);
+
+	cap.text_dumps++;
+	table_t &t = cap.tables[new_table(name)];
+
+	unwrap_t clock;
+	uint64_t skipped = 0;
+	size_t next = start.next;
+
+	while (next < len) {
+		line_t line = next_line(data, len, next);
+
+		if (line.text == "-------END-------") {
+			next = line.next;
+			break;
+		}
+
+		if (starts_with(line.text, "LOG OF VARIABLE: '")) {
+			// Cut short; the next dump starts here
+			break;
+		}
+
+		next = line.next;
+
+		int64_t timestamp;
+		double values[3];
+		int n = parse_sample(line.text, timestamp, values);
+
+		if (n == 0 || (!t.columns.empty() && (size_t) n != t.columns.size())) {
+			// Other console output mixed into the dump
+			skipped++;
+			continue;
+		}
+
+		if (t.columns.empty()) {
+			t.column_names = (n == 3) ? std::vector<std::string>{"mean", "min", "max"}
+					: std::vector<std::string>{"value"};
+			t.columns.resize(n);
+		}
+
+		// Printed with %ld, so large timestamps come out negative
+		t.time_usec.push_back(clock((uint32_t) timestamp));
+		for (int i = 0; i < n; i++) {
+			t.columns[i].push_back(values[i]);
+		}
+	}
+
+	if (skipped > 0) {
+		warn("text dump of '" + t.name + "': " + std::to_string(skipped) + " lines not understood, skipped");
+	}
+	if (t.num_rows() != num_samples) {
+		warn("text dump of '" + t.name + "': " + std::to_string(t.num_rows()) + " of "
+				+ std::to_string(num_samples) + " samples");
+	}
+
+	return next;
+}
+
+void decoder_t::run()
+{
+	static const char TEXT_MARK[] = "LOG OF VARIABLE: '";
+
+	// Every format starts with 'L' or 'A', so only those bytes
+	// are looked at more closely
+	size_t next_l = 0;
+	size_t next_a = 0;
+	size_t pos = 0;
+
+	while (pos < len) {
+		if (next_l < pos) {
+			const void *l = std::memchr(data + pos, 'L', len - pos);
+			next_l = l ? (const uint8_t *) l - data : len;
+		}
+		if (next_a < pos) {
+			const void *a = std::memchr(data + pos, 'A', len - pos);
+			next_a = a ? (const uint8_t *) a - data : len;
+		}
+
+		size_t c = std::min(next_l, next_a);
+		if (c >= len) {
+			break;
+		}
+
+		size_t left = len - c;
+		const uint8_t *p = data + c;
+		size_t end = 0;
+
+		if (*p == 'L') {
+			if (left >= 4 && std::memcmp(p, "LFR=", 4) == 0) {
+				end = parse_lfr(c);
+			} else if (left >= sizeof(TEXT_MARK) - 1 && std::memcmp(p, TEXT_MARK, sizeof(TEXT_MARK) - 1) == 0) {
+				end = parse_text(c);
+			}
+		} else if (left >= 4) {
+			uint32_t magic = get_u32(p);
+
+			if (magic == FRAME_MAGIC) {
+				end = parse_var(c);
+			} else if (magic == GROUP_MAGIC) {
+				end = parse_group(c);
+			} else if (magic == STREAM_MAGIC) {
+				end = parse_stream(c);
+			}
+		}
+
+		pos = (end > c) ? end : c + 1;
+	}
+
+	finish_lfr();
+}
+
+}
+
+capture_t decode_capture(const uint8_t *data, size_t len, const lfr_options_t &lfr)
+{
+	capture_t cap;
+	decoder_t(data, len, lfr, cap).run();
+	return cap;
+}
+
+table_t merge_tables(const std::vector<table_t> &tables, const std::string &name)
+{
+	table_t m;
+	m.name = name;
+
+	for (const table_t &t : tables) {
+		for (const std::string &col : t.column_names) {
+			m.column_names.push_back(t.columns.size() == 1 ? t.name : t.name + "." + col);
+		}
+	}
+	m.columns.resize(m.column_names.size());
+
+	// Walk all tables in time order at once
+	std::vector<size_t> heads(tables.size(), 0);
+
+	while (true) {
+		uint64_t now = UINT64_MAX;
+		for (size_t i = 0; i < tables.size(); i++) {
+			if (heads[i] < tables[i].num_rows()) {
+				now = std::min(now, tables[i].time_usec[heads[i]]);
+			}
+		}
+
+		if (now == UINT64_MAX) {
+			break;
+		}
+
+		m.time_usec.push_back(now);
+
+		size_t col = 0;
+		for (size_t i = 0; i < tables.size(); i++) {
+			const table_t &t = tables[i];
+			bool here = heads[i] < t.num_rows() && t.time_usec[heads[i]] == now;
+
+			for (size_t c = 0; c < t.columns.size(); c++) {
+				m.columns[col++].push_back(here ? t.columns[c][heads[i]] : NaN);
+			}
+
+			if (here) {
+				heads[i]++;
+			}
+		}
+	}
+
+	return m;
+}
+
+namespace {
+
+const size_t WRITE_CHUNK_BYTES = 1 << 20;
+
+template <typename T>
+void put_number(std::string &buf, T x)
+{
+	char tmp[32];
+	auto r = std::to_chars(tmp, tmp + sizeof(tmp), x);
+	buf.append(tmp, r.ptr);
+}
+
+// Column names become file names
+std::string file_name(std::string name)
+{
+	for (char &ch : name) {
+		if (ch == '/' || ch == '\\' || ch == ':' || ch == '\0') {
+			ch = '_';
+		}
+	}
+	return name;
+}
+
+template <typename T>
+bool write_array(const std::string &path, const std::vector<T> &values)
+{
+	std::FILE *f = std::fopen(path.c_str(), "wb");
+	if (f == nullptr) {
+		return false;
+	}
+
+	bool ok = std::fwrite(values.data(), sizeof(T), values.size(), f) == values.size();
+	return (std::fclose(f) == 0) && ok;
+}
+
+}
+
+bool write_csv(const table_t &t, std::FILE *f)
+{
+	std::string buf;
+	buf.reserve(WRITE_CHUNK_BYTES + 4096);
+
+	buf += "timestamp_usec";
+	if (!t.seq.empty()) {
+		buf += ",seq";
+	}
+	for (const std::string &col : t.column_names) {
+		buf += ',';
+		buf += col;
+	}
+	buf += '\n';
+
+	for (size_t i = 0; i < t.num_rows(); i++) {
+		put_number(buf, t.time_usec[i]);
+
+		if (!t.seq.empty()) {
+			buf += ',';
+			put_number(buf, t.seq[i]);
+		}
+
+		for (const std::vector<double> &col : t.columns) {
+			buf += ',';
+			if (!std::isnan(col[i])) {
+				// Shortest text which reads back as the same double
+				put_number(buf, col[i]);
+			}
+		}
+		buf += '\n';
+
+		if (buf.size() >= WRITE_CHUNK_BYTES) {
+			if (std::fwrite(buf.data(), 1, buf.size(), f) != buf.size()) {
+				return false;
+			}
+			buf.clear();
+		}
+	}
+
+	return std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+}
+
+bool write_columnar(const table_t &t, const std::string &dir)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	if (ec) {
+		return false;
+	}
+
+	std::string base = dir + "/";
+
+	if (!write_array(base + "timestamp_usec.u64", t.time_usec)) {
+		return false;
+	}
+
+	if (!t.seq.empty() && !write_array(base + "seq.u32", t.seq)) {
+		return false;
+	}
+
+	for (size_t c = 0; c < t.columns.size(); c++) {
+		if (!write_array(base + file_name(t.column_names[c]) + ".f64", t.columns[c])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+namespace {
+
+// Slicing-by-8 tables of the reflected CRC-32 polynomial
+typedef struct crc_tables_t {
+	uint32_t t[8][256];
+
+	crc_tables_t()
+	{
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+			}
+			t[0][i] = c;
+		}
+
+		for (int s = 1; s < 8; s++) {
+			for (int i = 0; i < 256; i++) {
+				t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+			}
+		}
+	}
+} crc_tables_t;
+
+const crc_tables_t crc_tables;
+
+}
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+	const auto &t = crc_tables.t;
+
+	crc = ~crc;
+
+	while (len >= 8) {
+		uint32_t lo = get_u32(p) ^ crc;
+		uint32_t hi = get_u32(p + 4);
+
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+			^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+
+		p += 8;
+		len -= 8;
+	}
+
+	while (len--) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+	}
+
+	return ~crc;
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef LOGDECODE_H
+#define LOGDECODE_H
+
+// Host-side decoding of AMDC log captures
+//
+// A capture is whatever came out of the serial console or TCP socket,
+// saved binary-safe to a file. It may hold any mix of:
+//
+//   - 'log dump <idx>' text dumps of the bare firmware
+//   - 'log dump bin ...' frames (AMDL / AMDG) and 'log stream' packets
+//     (AMDS) of the bare firmware, see sdk/bare/sys/log.h
+//   - 'LFR=sqn,idx,flags,len,<binary>' packets of the basic firmware,
+//     see MakeMostFullLFR() in sdk/basic/src/commands.c
+//
+// interleaved with any other console output, which is skipped. Each
+// source becomes one table: a timestamp per row, a sequence number if
+// the source has one, and one column of values per variable.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace amdc {
+
+typedef struct table_t {
+	std::string name;
+
+	// Unwrapped from the firmware's 32-bit microsecond timestamps
+	std::vector<uint64_t> time_usec;
+
+	// Empty if the source has no sequence numbers
+	std::vector<uint32_t> seq;
+
+	// Values are widened to double, which is exact
+	// for everything but 64-bit integers above 2^53
+	std::vector<std::string> column_names;
+	std::vector<std::vector<double>> columns;
+
+	// Rows missing from 'seq', and rows the target
+	// reported it dropped
+	uint64_t missing = 0;
+	uint64_t dropped = 0;
+
+	size_t num_rows() const { return time_usec.size(); }
+} table_t;
+
+// How to read the raw 32-bit words of the basic firmware's logs
+typedef enum word_type_e {
+	WORD_UINT32 = 1,
+	WORD_INT32,
+	WORD_FLOAT
+} word_type_e;
+
+typedef struct lfr_options_t {
+	// DoLogging() takes one sample of every log per timer tick
+	uint32_t period_usec = 10;
+
+	// Per log index; unlisted logs are WORD_UINT32 named "log<idx>"
+	std::map<int, word_type_e> types;
+	std::map<int, std::string> names;
+} lfr_options_t;
+
+typedef struct capture_t {
+	// In the order their first data appears in the capture
+	std::vector<table_t> tables;
+
+	uint64_t text_dumps = 0;
+	uint64_t frames = 0;
+	uint64_t bad_frames = 0;
+	uint64_t lfr_packets = 0;
+	uint64_t lfr_lost_packets = 0;
+
+	// Human readable notes on anything skipped or suspect
+	std::vector<std::string> warnings;
+} capture_t;
+
+// Decodes a whole capture held in memory
+capture_t decode_capture(const uint8_t *data, size_t len, const lfr_options_t &lfr = lfr_options_t());
+
+// Joins tables into one on their timestamps; a table without a value
+// at some row's time gets NaN there. Columns are named
+// '<table>.<column>', or just '<table>' for single column tables
+table_t merge_tables(const std::vector<table_t> &tables, const std::string &name);
+
+// CSV with a 'timestamp_usec[,seq],<column>,...' header row; NaN
+// values are left empty. Returns false on a write error
+bool write_csv(const table_t &t, std::FILE *f);
+
+// Columnar: a directory holding one file of packed little-endian
+// values per column, typed by extension:
+//
+//   timestamp_usec.u64, seq.u32 (if any), <column>.f64 ...
+//
+// so each loads directly, e.g. numpy.fromfile(path, '<f8')
+bool write_columnar(const table_t &t, const std::string &dir);
+
+// Same as zlib's crc32(), as used by the firmware's frames
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+
+}
+
+#endif // LOGDECODE_H
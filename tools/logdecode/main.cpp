@@ -0,0 +1,264 @@
+// Decodes an AMDC log capture into CSV or columnar files
+//
+// Capture the serial console or TCP output of any mix of 'log dump',
+// 'log dump bin', 'log stream' (bare firmware) and 'LFR' / 'LFS'
+// (basic firmware) to a file, binary-safe, then run:
+//
+//   amdc_logdecode capture.bin out_dir
+//   amdc_logdecode --format col capture.bin out_dir
+//
+// One output per table, named after the variable, 'group', 'stream'
+// or 'lfr' (repeats get '_1', '_2', ...):
+//
+//   csv -- '<table>.csv' with a 'timestamp_usec[,seq],<column>,...'
+//          header row
+//   col -- '<table>/' holding one packed little-endian file per column,
+//          see write_columnar() in logdecode.h
+//
+// --merge joins all tables on their timestamps into one 'merged'
+// output instead.
+//
+// The basic firmware's logs are raw 32-bit words without timestamps;
+// rows are numbered by sample and timed with --lfr-period. Use
+// --lfr-type <idx>=uint32|int32|float and --lfr-name <idx>=<name> to
+// say what each log holds.
+
+#include "logdecode.h"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace amdc;
+
+namespace {
+
+void usage()
+{
+	std::fprintf(stderr,
+		"usage: amdc_logdecode [--format csv|col] [--merge] [--lfr-period usec]\n"
+		"                      [--lfr-type idx=uint32|int32|float] [--lfr-name idx=name]\n"
+		"                      capture out_dir\n");
+}
+
+// Captures run to gigabytes, so map them instead of copying
+typedef struct capture_file_t {
+	const uint8_t *data = nullptr;
+	size_t len = 0;
+
+#ifndef _WIN32
+	void *map = MAP_FAILED;
+#endif
+	std::string copy;
+
+	bool open(const char *path);
+	~capture_file_t();
+} capture_file_t;
+
+bool capture_file_t::open(const char *path)
+{
+#ifndef _WIN32
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			data = (const uint8_t *) map;
+			len = st.st_size;
+			close(fd);
+			return true;
+		}
+	}
+	close(fd);
+#endif
+
+	std::ifstream f(path, std::ios::binary);
+	if (!f) {
+		return false;
+	}
+
+	copy.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+	data = (const uint8_t *) copy.data();
+	len = copy.size();
+	return true;
+}
+
+capture_file_t::~capture_file_t()
+{
+#ifndef _WIN32
+	if (map != MAP_FAILED) {
+		munmap(map, len);
+	}
+#endif
+}
+
+// Parses "<idx>=<rest>"
+bool parse_indexed(const char *arg, int &idx, std::string &rest)
+{
+	const char *eq = std::strchr(arg, '=');
+	if (eq == nullptr || eq == arg) {
+		return false;
+	}
+
+	char *end;
+	long x = std::strtol(arg, &end, 10);
+	if (end != eq || x < 0 || x > 255) {
+		return false;
+	}
+
+	idx = (int) x;
+	rest = eq + 1;
+	return !rest.empty();
+}
+
+bool write_table(const table_t &t, const std::string &out_dir, bool columnar, std::string &path)
+{
+	if (columnar) {
+		path = out_dir + "/" + t.name;
+		return write_columnar(t, path);
+	}
+
+	path = out_dir + "/" + t.name + ".csv";
+	std::FILE *f = std::fopen(path.c_str(), "wb");
+	if (f == nullptr) {
+		return false;
+	}
+
+	bool ok = write_csv(t, f);
+	return (std::fclose(f) == 0) && ok;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	bool columnar = false;
+	bool merge = false;
+	lfr_options_t lfr;
+	const char *args[2];
+	int num_args = 0;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		bool has_value = (i + 1 < argc);
+
+		if (a == "--format" && has_value) {
+			std::string f = argv[++i];
+			if (f != "csv" && f != "col") {
+				usage();
+				return 1;
+			}
+			columnar = (f == "col");
+		} else if (a == "--merge") {
+			merge = true;
+		} else if (a == "--lfr-period" && has_value) {
+			lfr.period_usec = (uint32_t) std::strtoul(argv[++i], nullptr, 10);
+			if (lfr.period_usec == 0) {
+				usage();
+				return 1;
+			}
+		} else if (a == "--lfr-type" && has_value) {
+			int idx;
+			std::string type;
+			if (!parse_indexed(argv[++i], idx, type)) {
+				usage();
+				return 1;
+			}
+
+			if (type == "uint32") {
+				lfr.types[idx] = WORD_UINT32;
+			} else if (type == "int32") {
+				lfr.types[idx] = WORD_INT32;
+			} else if (type == "float") {
+				lfr.types[idx] = WORD_FLOAT;
+			} else {
+				usage();
+				return 1;
+			}
+		} else if (a == "--lfr-name" && has_value) {
+			int idx;
+			std::string name;
+			if (!parse_indexed(argv[++i], idx, name)) {
+				usage();
+				return 1;
+			}
+			lfr.names[idx] = name;
+		} else if (a.size() > 1 && a[0] == '-') {
+			usage();
+			return 1;
+		} else if (num_args < 2) {
+			args[num_args++] = argv[i];
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+	if (num_args != 2) {
+		usage();
+		return 1;
+	}
+
+	capture_file_t file;
+	if (!file.open(args[0])) {
+		std::fprintf(stderr, "amdc_logdecode: can't read '%s'\n", args[0]);
+		return 1;
+	}
+
+	capture_t cap = decode_capture(file.data, file.len, lfr);
+
+	for (const std::string &w : cap.warnings) {
+		std::fprintf(stderr, "warning: %s\n", w.c_str());
+	}
+
+	if (cap.tables.empty()) {
+		std::fprintf(stderr, "amdc_logdecode: no logs found\n");
+		return 1;
+	}
+
+	std::string out_dir = args[1];
+	std::error_code ec;
+	std::filesystem::create_directories(out_dir, ec);
+
+	if (merge) {
+		table_t m = merge_tables(cap.tables, "merged");
+		cap.tables.clear();
+		cap.tables.push_back(std::move(m));
+	}
+
+	for (const table_t &t : cap.tables) {
+		std::string path;
+		if (!write_table(t, out_dir, columnar, path)) {
+			std::fprintf(stderr, "amdc_logdecode: can't write '%s'\n", path.c_str());
+			return 1;
+		}
+
+		std::printf("%s: %zu samples", t.name.c_str(), t.num_rows());
+		if (!t.seq.empty()) {
+			std::printf(", %llu missing (%llu dropped on target)",
+					(unsigned long long) t.missing, (unsigned long long) t.dropped);
+		}
+		std::printf(" -> %s\n", path.c_str());
+	}
+
+	if (cap.bad_frames > 0 || cap.lfr_lost_packets > 0) {
+		std::printf("%llu bad frames, %llu LFR packets lost\n",
+				(unsigned long long) cap.bad_frames, (unsigned long long) cap.lfr_lost_packets);
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Convert an AMDC event trace dump into Chrome / Perfetto trace JSON.
+
+Capture the serial console output of the 'trace dump' command to a file
+(binary-safe, e.g. with your terminal's raw logging), then run:
+
+    python3 trace2json.py capture.bin trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+"""
+
+import json
+import re
+import struct
+import sys
+
+# Must match trace_event_e in sdk/bare/sys/trace.h
+TASK_BEGIN = 1
+TASK_END = 2
+ISR_ENTER = 3
+ISR_EXIT = 4
+CMD_BEGIN = 5
+CMD_END = 6
+MARKER = 7
+
+RECORD = struct.Struct('<IHH')
+
+# Thread IDs used in the output
+TID_BACKGROUND = 0
+TID_ISR = 1
+
+
+def parse_dump(data):
+    begin = re.search(rb'TRACE BEGIN (\d+) (\d+)\r\n', data)
+    if begin is None:
+        raise ValueError('no TRACE BEGIN header found')
+    ticks_per_sec = int(begin.group(2))
+
+    raw = re.compile(rb'TRACE RAW (\d+)\r\n').search(data, begin.end())
+    if raw is None:
+        raise ValueError('no TRACE RAW section found')
+
+    names = {}
+    for m in re.finditer(rb'TRACE NAME (\d+) (\d+) (\S+)\r\n', data[begin.end():raw.start()]):
+        names[(int(m.group(1)), int(m.group(2)))] = m.group(3).decode('ascii', 'replace')
+
+    num_bytes = int(raw.group(1))
+    payload = data[raw.end():raw.end() + num_bytes]
+    if len(payload) != num_bytes:
+        raise ValueError('capture truncated: expected %d bytes, got %d' % (num_bytes, len(payload)))
+
+    records = [RECORD.unpack_from(payload, off) for off in range(0, num_bytes, RECORD.size)]
+    return ticks_per_sec, names, records
+
+
+def to_chrome(ticks_per_sec, names, records):
+    events = []
+    usec_per_tick = 1e6 / ticks_per_sec
+
+    # Unwrap the 32-bit timestamps into a monotonic
+    # 64-bit timeline starting at the first record
+    last = None
+    base = -records[0][0] if records else 0
+    isr_depth = 0
+
+    for ts, event, ident in records:
+        if last is not None and ts < last:
+            base += 1 << 32
+        last = ts
+        t = (base + ts) * usec_per_tick
+
+        tid = TID_ISR if isr_depth > 0 else TID_BACKGROUND
+
+        if event in (TASK_BEGIN, TASK_END):
+            name = names.get((TASK_BEGIN, ident), 'task%d' % ident)
+            events.append({'name': name, 'cat': 'task', 'ph': 'B' if event == TASK_BEGIN else 'E',
+                           'ts': t, 'pid': 0, 'tid': tid})
+        elif event == ISR_ENTER:
+            isr_depth += 1
+            events.append({'name': 'SysTick', 'cat': 'isr', 'ph': 'B', 'ts': t, 'pid': 0, 'tid': TID_ISR})
+        elif event == ISR_EXIT:
+            isr_depth = max(isr_depth - 1, 0)
+            events.append({'name': 'SysTick', 'cat': 'isr', 'ph': 'E', 'ts': t, 'pid': 0, 'tid': TID_ISR})
+        elif event in (CMD_BEGIN, CMD_END):
+            name = names.get((CMD_BEGIN, ident), 'cmd%d' % ident)
+            events.append({'name': name, 'cat': 'cmd', 'ph': 'B' if event == CMD_BEGIN else 'E',
+                           'ts': t, 'pid': 0, 'tid': tid})
+        elif event == MARKER:
+            events.append({'name': 'mark %d' % ident, 'cat': 'marker', 'ph': 'i', 's': 't',
+                           'ts': t, 'pid': 0, 'tid': tid})
+
+    # A ring buffer starts mid-stream, so drop end events
+    # whose begin was overwritten before the dump
+    open_spans = {}
+    cleaned = []
+    for e in events:
+        key = (e['tid'], e['name'])
+        if e['ph'] == 'B':
+            open_spans[key] = open_spans.get(key, 0) + 1
+        elif e['ph'] == 'E':
+            if open_spans.get(key, 0) == 0:
+                continue
+            open_spans[key] -= 1
+        cleaned.append(e)
+
+    meta = [
+        {'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': TID_BACKGROUND, 'args': {'name': 'background'}},
+        {'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': TID_ISR, 'args': {'name': 'SysTick ISR'}},
+    ]
+    return {'traceEvents': meta + cleaned, 'displayTimeUnit': 'ns'}
+
+
+def main(argv):
+    if len(argv) != 3:
+        print('usage: %s <capture> <out.json>' % argv[0], file=sys.stderr)
+        return 1
+
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+
+    ticks_per_sec, names, records = parse_dump(data)
+    with open(argv[2], 'w') as f:
+        json.dump(to_chrome(ticks_per_sec, names, records), f)
+
+    print('%d records -> %s' % (len(records), argv[2]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))